@@ -17,10 +17,15 @@
     along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "qjsonsortfilterproxymodel.h"
+#include <QtConcurrentMap>
 
 QJsonSortFilterProxyModel::QJsonSortFilterProxyModel(QObject *parent) :
   QSortFilterProxyModel(parent)
 {
+  m_sortKeysColumn = -1;
+  m_sortKeysCase = Qt::CaseSensitive;
+  m_naturalSort = false;
+  m_queryUpdateScheduled = false;
 }
 
 QJsonSortFilterProxyModel::~QJsonSortFilterProxyModel()
@@ -29,37 +34,520 @@ QJsonSortFilterProxyModel::~QJsonSortFilterProxyModel()
 
 bool QJsonSortFilterProxyModel::filterAcceptsRow ( int source_row, const QModelIndex & source_parent ) const
 {
+  const QJsonTreeModel* model = static_cast<const QJsonTreeModel*>(sourceModel());
   if (!source_parent.isValid())
-    return true;
+  {
+    // rows directly under the root are filtered by the query only
+    return (m_query.isEmpty() || m_queryShown.contains(model->root()->child(source_row)));
+  }
 
-  const QJsonTreeModel* model = static_cast<const QJsonTreeModel*>(source_parent.model());
   QJsonTreeItem* item = model->itemByModelIndex(source_parent)->child(source_row);
+  return acceptsItem(model,item);
+}
+
+void QJsonSortFilterProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+  if (this->sourceModel())
+  {
+    disconnect (this->sourceModel(),SIGNAL(dataChanged(QModelIndex,QModelIndex)),this,SLOT(onSourceDataChanged(QModelIndex,QModelIndex)));
+    disconnect (this->sourceModel(),SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),this,SLOT(onSourceRowsAboutToBeRemoved(QModelIndex,int,int)));
+    disconnect (this->sourceModel(),SIGNAL(modelAboutToBeReset()),this,SLOT(onSourceAboutToBeReset()));
+    disconnect (this->sourceModel(),SIGNAL(rowsInserted(QModelIndex,int,int)),this,SLOT(onSourceRowsInserted(QModelIndex,int,int)));
+    disconnect (this->sourceModel(),SIGNAL(rowsRemoved(QModelIndex,int,int)),this,SLOT(scheduleQueryUpdate()));
+    disconnect (this->sourceModel(),SIGNAL(modelReset()),this,SLOT(scheduleQueryUpdate()));
+  }
+  clearSortKeys();
+
+  // connected before the base class, so the stale keys are gone when it sorts the changed rows again, and the inserted
+  // rows are already evaluated by the query when it filters them
+  if (sourceModel)
+  {
+    connect (sourceModel,SIGNAL(dataChanged(QModelIndex,QModelIndex)),this,SLOT(onSourceDataChanged(QModelIndex,QModelIndex)));
+    connect (sourceModel,SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),this,SLOT(onSourceRowsAboutToBeRemoved(QModelIndex,int,int)));
+    connect (sourceModel,SIGNAL(modelAboutToBeReset()),this,SLOT(onSourceAboutToBeReset()));
+    connect (sourceModel,SIGNAL(rowsInserted(QModelIndex,int,int)),this,SLOT(onSourceRowsInserted(QModelIndex,int,int)));
+    connect (sourceModel,SIGNAL(rowsRemoved(QModelIndex,int,int)),this,SLOT(scheduleQueryUpdate()));
+    connect (sourceModel,SIGNAL(modelReset()),this,SLOT(scheduleQueryUpdate()));
+  }
+  QSortFilterProxyModel::setSourceModel(sourceModel);
+  updateQueryMatches();
+}
+
+void QJsonSortFilterProxyModel::setFilterQuery(const QJsonTreeQuery &query)
+{
+  m_query = query;
+  updateQueryMatches();
+  invalidateFilter();
+}
+
+void QJsonSortFilterProxyModel::updateQueryMatches()
+{
+  m_queryShown.clear();
+  const QJsonTreeModel* model = static_cast<const QJsonTreeModel*>(sourceModel());
+  if (m_query.isEmpty() || !model || !model->root())
+    return;
+  foreach (QJsonTreeItem* child, model->root()->children())
+    collectQueryMatches(child,false);
+}
+
+bool QJsonSortFilterProxyModel::collectQueryMatches(const QJsonTreeItem *item, bool ancestorMatched)
+{
+  // the subtree of a match is shown, and the path to it
+  bool matched = (ancestorMatched || m_query.matches(item));
+  bool shown = matched;
+  foreach (QJsonTreeItem* child, item->children())
+  {
+    if (collectQueryMatches(child,matched))
+      shown = true;
+  }
+  if (shown)
+    m_queryShown.insert(item);
+  return shown;
+}
+
+void QJsonSortFilterProxyModel::onSourceRowsInserted(const QModelIndex &parent, int start, int end)
+{
+  if (m_query.isEmpty())
+    return;
+
+  // the new subtrees are evaluated right away, so they're not hidden until the queued update
+  const QJsonTreeModel* model = static_cast<const QJsonTreeModel*>(sourceModel());
+  QJsonTreeItem* parentItem = model->itemByModelIndex(parent);
+  if (!parentItem)
+    parentItem = model->root();
+  bool ancestorMatched = false;
+  for (const QJsonTreeItem* a = parentItem; a && a != model->root() && !ancestorMatched; a = a->parent())
+    ancestorMatched = m_query.matches(a);
+
+  bool shown = false;
+  for (int i=start; i <= end; i++)
+  {
+    if (collectQueryMatches(parentItem->child(i),ancestorMatched))
+      shown = true;
+  }
+  if (!shown)
+    return;
+
+  // the path to them must be shown too, only a newly shown ancestor needs the whole filter updated
+  bool changed = false;
+  for (const QJsonTreeItem* a = parentItem; a && a != model->root(); a = a->parent())
+  {
+    if (m_queryShown.contains(a))
+      break;
+    m_queryShown.insert(a);
+    changed = true;
+  }
+  if (changed)
+    scheduleQueryUpdate();
+}
+
+void QJsonSortFilterProxyModel::onSourceRowsAboutToBeRemoved(const QModelIndex &parent, int start, int end)
+{
+  // removed items memory may be reused by new items, so they can't stay in the shown set
+  clearSortKeys();
+  if (m_queryShown.isEmpty())
+    return;
+  const QJsonTreeModel* model = static_cast<const QJsonTreeModel*>(sourceModel());
+  QJsonTreeItem* parentItem = model->itemByModelIndex(parent);
+  if (!parentItem)
+    parentItem = model->root();
+  QList<const QJsonTreeItem*> items;
+  for (int i=start; i <= end; i++)
+    items.append(parentItem->child(i));
+  while (!items.isEmpty())
+  {
+    const QJsonTreeItem* item = items.takeLast();
+    if (!m_queryShown.remove(item))
+      continue;
+    // children of an hidden item are hidden too
+    foreach (QJsonTreeItem* child, item->children())
+      items.append(child);
+  }
+}
+
+void QJsonSortFilterProxyModel::onSourceAboutToBeReset()
+{
+  clearSortKeys();
+  m_queryShown.clear();
+}
+
+void QJsonSortFilterProxyModel::scheduleQueryUpdate()
+{
+  // the changed rows may change their ancestors visibility too, the whole filter is updated once control returns to the event loop
+  if (m_query.isEmpty() || m_queryUpdateScheduled)
+    return;
+  m_queryUpdateScheduled = true;
+  QMetaObject::invokeMethod(this,"updateQuery",Qt::QueuedConnection);
+}
+
+void QJsonSortFilterProxyModel::updateQuery()
+{
+  m_queryUpdateScheduled = false;
+  updateQueryMatches();
+  invalidateFilter();
+}
+
+void QJsonSortFilterProxyModel::setNaturalSortEnabled(bool enable)
+{
+  if (m_naturalSort == enable)
+    return;
+  m_naturalSort = enable;
+  clearSortKeys();
+  if (sortColumn() >= 0)
+    invalidate();
+}
+
+void QJsonSortFilterProxyModel::onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+  scheduleQueryUpdate();
+  if (m_sortKeys.isEmpty())
+    return;
+  const QJsonTreeModel* model = static_cast<const QJsonTreeModel*>(sourceModel());
+  QJsonTreeItem* parent = model->itemByModelIndex(topLeft.parent());
+  if (!parent)
+    parent = model->root();
+  for (int i=topLeft.row(); i <= bottomRight.row(); i++)
+    m_sortKeys.remove(parent->child(i));
+}
+
+void QJsonSortFilterProxyModel::clearSortKeys()
+{
+  // removed items memory may be reused by new items, so keys are never kept past a removal
+  m_sortKeys.clear();
+}
+
+static QStringList naturalParts(const QString& text)
+{
+  QStringList parts;
+  int start = 0;
+  for (int i=1; i <= text.length(); i++)
+  {
+    if (i == text.length() || text.at(i).isDigit() != text.at(start).isDigit())
+    {
+      parts.append(text.mid(start,i - start));
+      start = i;
+    }
+  }
+  return parts;
+}
+
+QJsonTreeSortKey QJsonSortFilterProxyModel::sortKey(const QJsonTreeItem *item, int column) const
+{
+  QHash<const QJsonTreeItem*, QJsonTreeSortKey>::const_iterator it = m_sortKeys.constFind(item);
+  if (it != m_sortKeys.constEnd())
+    return it.value();
+
+  // read the value straight from the item map, as data() does for the display role
+  QJsonTreeSortKey key;
+  key.type = QJsonTreeSortKey::Empty;
+  key.number = 0;
+  QVariant v;
+  if (!item->headerIsDrawn(column))
+    v = item->m_map.value(item->headerTagByIdx(column));
+
+  switch (v.type())
+  {
+    case QVariant::Invalid:
+    break;
+
+    case QVariant::Bool:
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+    case QVariant::Double:
+      key.number = v.toDouble();
+      if (qIsFinite(key.number))
+      {
+        key.type = QJsonTreeSortKey::Number;
+        break;
+      }
+      key.number = 0;
+      // nan and infinities break the numbers ordering, they sort as text
+      // fall through
+
+    default:
+    {
+      // values edited in the view are strings, numeric ones still sort as numbers ("nan" and "inf" are text)
+      QString s = v.toString();
+      bool ok = false;
+      double d = s.toDouble(&ok);
+      if (ok && qIsFinite(d))
+      {
+        key.type = QJsonTreeSortKey::Number;
+        key.number = d;
+      }
+      else if (!s.isEmpty())
+      {
+        key.type = QJsonTreeSortKey::Text;
+        key.text = (m_sortKeysCase == Qt::CaseInsensitive ? s.toLower() : s);
+        if (m_naturalSort)
+          key.parts = naturalParts(key.text);
+      }
+    }
+    break;
+  }
+  m_sortKeys.insert(item,key);
+  return key;
+}
+
+int QJsonSortFilterProxyModel::compareSortKeys(const QJsonTreeSortKey &a, const QJsonTreeSortKey &b) const
+{
+  if (a.type != b.type)
+    return a.type - b.type;
+
+  switch (a.type)
+  {
+    case QJsonTreeSortKey::Number:
+      if (a.number == b.number)
+        return 0;
+      return (a.number < b.number ? -1 : 1);
+
+    case QJsonTreeSortKey::Text:
+      if (!m_naturalSort)
+        return QString::localeAwareCompare(a.text,b.text);
+
+      for (int i=0; i < a.parts.count() && i < b.parts.count(); i++)
+      {
+        const QString& pa = a.parts.at(i);
+        const QString& pb = b.parts.at(i);
+        int res;
+        if (pa.at(0).isDigit() && pb.at(0).isDigit())
+        {
+          // compare digits runs by value, without converting (they may not fit a number): longer without leading zeroes is greater
+          int za = 0;
+          while (za < pa.length() - 1 && pa.at(za) == '0')
+            za++;
+          int zb = 0;
+          while (zb < pb.length() - 1 && pb.at(zb) == '0')
+            zb++;
+          res = (pa.length() - za) - (pb.length() - zb);
+          if (res == 0)
+            res = QString::compare(pa.mid(za),pb.mid(zb));
+        }
+        else
+        {
+          res = QString::localeAwareCompare(pa,pb);
+        }
+        if (res != 0)
+          return res;
+      }
+      return a.parts.count() - b.parts.count();
+
+    default:
+      return 0;
+  }
+}
+
+bool QJsonSortFilterProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+{
+  const QJsonTreeModel* model = static_cast<const QJsonTreeModel*>(sourceModel());
+  QJsonTreeItem* l = model->itemByModelIndex(left);
+  QJsonTreeItem* r = model->itemByModelIndex(right);
+  if (!l || !r || (sortRole() != Qt::DisplayRole && sortRole() != Qt::EditRole))
+  {
+    // the keys hold the displayed values, other roles are compared by the base class
+    return QSortFilterProxyModel::lessThan(left,right);
+  }
+
+  // keys are for a single column
+  if (left.column() != m_sortKeysColumn || sortCaseSensitivity() != m_sortKeysCase)
+  {
+    m_sortKeys.clear();
+    m_sortKeysColumn = left.column();
+    m_sortKeysCase = sortCaseSensitivity();
+  }
+  return compareSortKeys(sortKey(l,left.column()),sortKey(r,right.column())) < 0;
+}
+
+bool QJsonSortFilterProxyModel::acceptsItem(const QJsonTreeModel* model, const QJsonTreeItem *item) const
+{
   int flags = model->specialFlags();
-  if (item->map().contains("_template_"))
+  if (item->isTemplate())
+    return false;
+
+  if (!m_query.isEmpty() && !m_queryShown.contains(item))
+    return false;
+
+  if (item->hasReadOnlySet() && (flags & QJsonTreeItem::ReadOnlyHidesRow) && (flags & QJsonTreeItem::HonorHide))
     return false;
 
-  bool roset = item->map().value("__hasROSet__",false).toBool();
-  if (roset && (flags & QJsonTreeItem::ReadOnlyHidesRow) && (flags & QJsonTreeItem::HonorHide))
+  if (item->isRowHidden() && (flags & QJsonTreeItem::HonorHide))
     return false;
+  return true;
+}
 
-  bool hide = item->map().value("_hide_",false).toBool();
-  if (hide && (flags & QJsonTreeItem::HonorHide))
+bool QJsonSortFilterProxyModel::isItemShown(const QJsonTreeModel* model, const QJsonTreeItem *item) const
+{
+  // rows directly under the root item are always accepted, the others need all their ancestors accepted too
+  const QJsonTreeItem* root = model->root();
+  while (item && item != root && item->parent() != root)
+  {
+    if (!acceptsItem(model,item))
+      return false;
+    item = item->parent();
+  }
+  if (item == 0 || item == root)
     return false;
+  return (m_query.isEmpty() || m_queryShown.contains(item));
+}
 
-  // check regexp on each column
-  if (this->filterRegExp().isEmpty())
-    return true;
-  int cols = item->columnCount();
-  for (int i=0; i < cols; i++)
+void QJsonSortFilterProxyModel::collectSubtree(const QJsonTreeModel* model, QJsonTreeItem *item, const QJsonTreeSearchIndex::Query& query, QVector<QJsonTreeItem*> *items) const
+{
+  foreach (QJsonTreeItem* child, item->children())
   {
-    // select ?
-    if (item->text(i).contains(this->filterRegExp()))
+    // rows directly under the root item are never matched (as they're never filtered)
+    if (item != model->root())
     {
-      QModelIndex mi = this->mapFromSource(model->indexByItem(item,i));
-      item->view()->selectionModel()->select(mi,QItemSelectionModel::Select);
+      if (!acceptsItem(model,child))
+        continue;
+      if (!model->searchIndex() || model->searchIndex()->mayMatch(child,query))
+        items->append(child);
     }
+
+    // recurse
+    collectSubtree(model,child,query,items);
   }
-  return true;
+}
+
+/**
+ * @brief a range of the items to be searched, scanned by a thread of the pool
+ *
+ */
+struct QJsonTreeSearchChunk
+{
+  const QVector<QJsonTreeItem*>* items;
+  int begin;
+  int end;
+  QRegExp rx;
+};
+
+typedef QVector<QPair<QJsonTreeItem*, int> > QJsonTreeSearchChunkMatches;
+
+static QJsonTreeSearchChunkMatches matchChunk(const QJsonTreeSearchChunk& chunk)
+{
+  // items are only read here. each chunk has its own QRegExp, which keeps the matching state
+  QRegExp rx(chunk.rx.pattern(),chunk.rx.caseSensitivity(),chunk.rx.patternSyntax());
+  QJsonTreeSearchChunkMatches matches;
+  for (int i=chunk.begin; i < chunk.end; i++)
+  {
+    QJsonTreeItem* item = chunk.items->at(i);
+    int cols = item->columnCount();
+    for (int c=0; c < cols; c++)
+    {
+      if (item->text(c).contains(rx))
+        matches.append(qMakePair(item,c));
+    }
+  }
+  return matches;
+}
+
+void QJsonSortFilterProxyModel::matchItems(const QJsonTreeModel* model, const QVector<QJsonTreeItem*>& items, const QRegExp &rx, QModelIndexList *matches) const
+{
+  QList<QJsonTreeSearchChunk> chunks;
+  for (int i=0; i < items.count(); i += JSON_TREE_SEARCH_CHUNK_SIZE)
+  {
+    QJsonTreeSearchChunk c;
+    c.items = &items;
+    c.begin = i;
+    c.end = qMin(i + JSON_TREE_SEARCH_CHUNK_SIZE,items.count());
+    c.rx = rx;
+    chunks.append(c);
+  }
+
+  QList<QJsonTreeSearchChunkMatches> results;
+  if (chunks.count() > 1 && QThreadPool::globalInstance()->maxThreadCount() > 1)
+  {
+    // consecutive ranges of the pre-order list are scanned on the thread pool, the results come back in chunks order
+    results = QtConcurrent::blockingMapped<QList<QJsonTreeSearchChunkMatches> >(chunks,matchChunk);
+  }
+  else
+  {
+    foreach (QJsonTreeSearchChunk c, chunks)
+    {
+      results.append(matchChunk(c));
+    }
+  }
+
+  // the indexes are built here, on the caller (GUI) thread
+  foreach (QJsonTreeSearchChunkMatches r, results)
+  {
+    for (int i=0; i < r.count(); i++)
+    {
+      matches->append(model->indexByItem(r.at(i).first,r.at(i).second));
+    }
+  }
+}
+
+static void treePosition(const QJsonTreeItem* item, QVector<int>* position)
+{
+  // the rows from the root item down to the item
+  while (item->parent())
+  {
+    position->prepend(item->row());
+    item = item->parent();
+  }
+}
+
+QModelIndexList QJsonSortFilterProxyModel::searchMatches(const QRegExp &rx) const
+{
+  QModelIndexList matches;
+  const QJsonTreeModel* model = static_cast<const QJsonTreeModel*>(sourceModel());
+  if (!model || !model->root() || rx.isEmpty())
+    return matches;
+
+  const QJsonTreeSearchIndex* index = model->searchIndex();
+  QJsonTreeSearchIndex::Query query = QJsonTreeSearchIndex::compile(rx);
+  QVector<QJsonTreeItem*> items;
+  if (!index || !query.isRestricted())
+  {
+    // walk the whole tree, which gives the tree order straight away
+    collectSubtree(model,model->root(),query,&items);
+  }
+  else
+  {
+    // check only the index candidates, put in tree order
+    QList<QPair<QVector<int>, QJsonTreeItem*> > found;
+    foreach (QJsonTreeItem* item, index->candidates(query))
+    {
+      if (!isItemShown(model,item) || item->parent() == model->root())
+        continue;
+      QVector<int> position;
+      treePosition(item,&position);
+      found.append(qMakePair(position,item));
+    }
+    qSort(found.begin(),found.end(),positionLessThan);
+    items.reserve(found.count());
+    for (int i=0; i < found.count(); i++)
+    {
+      items.append(found.at(i).second);
+    }
+  }
+
+  matchItems(model,items,rx,&matches);
+  return matches;
+}
+
+QModelIndexList QJsonSortFilterProxyModel::searchMatches(const QRegExp &rx, const QVector<QJsonTreeItem *> &items) const
+{
+  QModelIndexList matches;
+  const QJsonTreeModel* model = static_cast<const QJsonTreeModel*>(sourceModel());
+  if (!model || rx.isEmpty())
+    return matches;
+  matchItems(model,items,rx,&matches);
+  return matches;
+}
+
+bool QJsonSortFilterProxyModel::positionLessThan(const QPair<QVector<int>, QJsonTreeItem*>& a, const QPair<QVector<int>, QJsonTreeItem*>& b)
+{
+  // QVector comparison isn't available on Qt4, compare the rows lexicographically (a parent comes before its children)
+  int n = qMin(a.first.size(),b.first.size());
+  for (int i=0; i < n; i++)
+  {
+    if (a.first.at(i) != b.first.at(i))
+      return a.first.at(i) < b.first.at(i);
+  }
+  return a.first.size() < b.first.size();
 }
 
 QModelIndex QJsonSortFilterProxyModel::indexToSourceIndex (const QModelIndex& index)
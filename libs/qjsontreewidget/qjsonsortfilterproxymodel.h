@@ -24,6 +24,26 @@
 #include <QTreeView>
 #include "qjsontreemodel.h"
 #include "qjsontreeitem.h"
+#include "qjsontreequery.h"
+
+#define JSON_TREE_SEARCH_CHUNK_SIZE 2048 // items scanned by a single thread pool job in searchMatches()
+
+/**
+ * @brief the value of an item in the sort column, converted once for the comparisons of lessThan()
+ *
+ */
+struct QJsonTreeSortKey
+{
+  enum Type {
+    Empty = 0, // empty values sort first, then numbers, then text
+    Number = 1,
+    Text = 2
+  };
+  int type;
+  double number; // numbers and booleans
+  QString text; // lowercase when sorting case insensitive
+  QStringList parts; // text split in digits and non digits runs, for natural sort only
+};
 
 class QJsonSortFilterProxyModel : public QSortFilterProxyModel
 {
@@ -40,6 +60,18 @@ protected:
   */
   virtual bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const;
 
+ /**
+  * @brief reimplementation of lessThan() from the QSortFilterProxyModel interface. compares the typed keys of the items values (numbers
+  * numerically, text locale aware), which are computed once and kept until the item is edited or the sort column changes.
+  * the keys are read from the items maps, so they're used only when sortRole() is Qt::DisplayRole or Qt::EditRole (the same values there),
+  * any other role is compared by QSortFilterProxyModel::lessThan()
+  *
+  * @param left the left source model index
+  * @param right the right source model index
+  * @return bool
+  */
+  virtual bool lessThan(const QModelIndex &left, const QModelIndex &right) const;
+
 public:
   /**
    * @brief constructor
@@ -78,6 +110,104 @@ public:
    */
   static const QJsonTreeModel* indexSourceModel (const QModelIndex& index);
 
+  /**
+   * @brief reimplementation of setSourceModel() from the QAbstractProxyModel interface, to track edits invalidating the sort keys
+   *
+   * @param sourceModel the source model
+   */
+  virtual void setSourceModel(QAbstractItemModel *sourceModel);
+
+  /**
+   * @brief enables natural sort for text values, so that i.e. "item2" sorts before "item10". default is disabled
+   *
+   * @param enable true to enable
+   */
+  void setNaturalSortEnabled(bool enable);
+
+  /**
+   * @brief returns whether natural sort is enabled
+   *
+   * @return bool
+   */
+  bool naturalSortEnabled() const { return m_naturalSort; }
+
+  /**
+   * @brief filters the rows with a compiled query: an item is shown when it matches, or when one of its ancestors or descendants does.
+   * the matches are computed in a single pass over the tree, and again (once per event loop iteration) after the source model changes
+   *
+   * @param query the query, an empty one removes the filter
+   */
+  void setFilterQuery(const QJsonTreeQuery& query);
+
+  /**
+   * @brief returns the query set by setFilterQuery()
+   *
+   * @return QJsonTreeQuery
+   */
+  QJsonTreeQuery filterQuery() const { return m_query; }
+
+  /**
+   * @brief filters all the rows again, without sorting (i.e. after source changes notified while dynamicSortFilter() was off)
+   *
+   */
+  void refilter() { invalidateFilter(); }
+
+  /**
+   * @brief returns the source model indexes of the cells whose text matches rx, in tree order. only the rows accepted by the filter are checked
+   * (rows directly under the root are never matched), and when the source model has a search index only its candidates are.
+   * the rows are listed in tree order on the calling thread, then scanned in ranges of JSON_TREE_SEARCH_CHUNK_SIZE on the global QThreadPool,
+   * reading the items only
+   *
+   * @param rx the regular expression
+   * @return QModelIndexList
+   */
+  QModelIndexList searchMatches (const QRegExp& rx) const;
+
+  /**
+   * @brief as searchMatches(), checking only the given items (i.e. the items matched by a previous search)
+   *
+   * @param rx the regular expression
+   * @param items the items to check, in tree order
+   * @return QModelIndexList
+   */
+  QModelIndexList searchMatches (const QRegExp& rx, const QVector<QJsonTreeItem*>& items) const;
+
+  /**
+   * @brief returns whether item is shown, that is the filter accepts it and all its ancestors
+   *
+   * @param model the source model
+   * @param item the item
+   * @return bool
+   */
+  bool isItemShown (const QJsonTreeModel* model, const QJsonTreeItem* item) const;
+
+private slots:
+  void onSourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
+  void clearSortKeys();
+  void onSourceRowsInserted(const QModelIndex& parent, int start, int end);
+  void onSourceRowsAboutToBeRemoved(const QModelIndex& parent, int start, int end);
+  void onSourceAboutToBeReset();
+  void scheduleQueryUpdate();
+  void updateQuery();
+
+private:
+  QJsonTreeSortKey sortKey(const QJsonTreeItem* item, int column) const;
+  int compareSortKeys(const QJsonTreeSortKey& a, const QJsonTreeSortKey& b) const;
+  bool acceptsItem(const QJsonTreeModel* model, const QJsonTreeItem* item) const;
+  void updateQueryMatches();
+  bool collectQueryMatches(const QJsonTreeItem* item, bool ancestorMatched);
+  void collectSubtree(const QJsonTreeModel* model, QJsonTreeItem* item, const QJsonTreeSearchIndex::Query& query, QVector<QJsonTreeItem*>* items) const;
+  void matchItems(const QJsonTreeModel* model, const QVector<QJsonTreeItem*>& items, const QRegExp& rx, QModelIndexList* matches) const;
+  static bool positionLessThan(const QPair<QVector<int>, QJsonTreeItem*>& a, const QPair<QVector<int>, QJsonTreeItem*>& b);
+
+  mutable QHash<const QJsonTreeItem*, QJsonTreeSortKey> m_sortKeys;
+  mutable int m_sortKeysColumn;
+  mutable Qt::CaseSensitivity m_sortKeysCase;
+  bool m_naturalSort;
+  QJsonTreeQuery m_query;
+  QSet<const QJsonTreeItem*> m_queryShown;
+  bool m_queryUpdateScheduled;
+
 };
 
 #endif // QJSONSORTFILTERPROXYMODEL_H
@@ -0,0 +1,94 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qjsontreeheaders.h"
+
+bool QJsonTreeHeaders::parse(const QString &headers)
+{
+  // split columns string
+  QStringList l = headers.split(",");
+  if (l.isEmpty())
+  {
+    // something wrong, "_headers_" empty/missing
+    return false;
+  }
+  m_count = l.count();
+  m_tags.resize(m_count);
+  m_names.resize(m_count);
+  m_draw.fill(false,m_count);
+
+  foreach (QString s, l)
+  {
+    QStringList sl = s.split(":");
+    if (sl.count() < 3)
+    {
+      // something wrong in the "_headers_" tag,
+      return false;
+    }
+
+    int idx = sl.at(2).toInt();
+    if (idx < 0)
+      return false;
+    if (idx >= m_tags.size())
+    {
+      // sparse indexes, grow the arrays
+      m_tags.resize(idx + 1);
+      m_names.resize(idx + 1);
+      m_draw.resize(idx + 1);
+    }
+
+    // save name, jsontag and draw flag at the header idx
+    m_names[idx] = sl.at(0);
+    m_tags[idx] = sl.at(1);
+    if (sl.count() == 4)
+    {
+      // this column item need to be drawn. there must be an option at the corresponding item map with i.e. tag=QPushButton,buttontext
+      m_draw[idx] = (sl.at(3).compare("draw",Qt::CaseInsensitive) == 0);
+    }
+
+    // name, jsontag and idx string can all be used for the reverse lookup
+    m_lookup[sl.at(0)] = idx;
+    m_lookup[sl.at(1)] = idx;
+    m_lookup[sl.at(2)] = idx;
+  }
+  return true;
+}
+
+QHash<QString, QHash<QString, QVariant> > QJsonTreeHeaders::toHash() const
+{
+  QHash<QString, QHash<QString, QVariant> > headers;
+  for (int i=0; i < m_tags.size(); i++)
+  {
+    if (m_tags.at(i).isEmpty() && m_names.at(i).isEmpty())
+      continue;
+
+    QHash <QString,QVariant> h;
+    h["__name__"]=m_names.at(i);
+    h["__tag__"]=m_tags.at(i);
+    h["__idx__"]=i;
+    if (m_draw.at(i))
+      h["__draw__"]=true;
+
+    // use the same values as keys in the parent hash
+    headers[m_names.at(i)] = h;
+    headers[m_tags.at(i)] = h;
+    headers[QString::number(i)] = h;
+  }
+  return headers;
+}
@@ -0,0 +1,101 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QJSONTREEHEADERS_H
+#define QJSONTREEHEADERS_H
+
+#include <QtCore>
+
+/**
+ * @brief immutable columns descriptor built once from the JSON root map "_headers_" string (<columndisplayname:JSONtag:columnidx[:draw],...>).
+ * it's owned by the root item and shared (by reference) by all the items of the tree
+ *
+ */
+class QJsonTreeHeaders : public QSharedData
+{
+public:
+  /**
+   * @brief constructor, builds an empty descriptor
+   *
+   */
+  QJsonTreeHeaders() { m_count = 0; }
+
+  /**
+   * @brief parses the "_headers_" string. on failure, the columns parsed so far are kept
+   *
+   * @param headers the "_headers_" string
+   * @return bool false if the string is empty or malformed
+   */
+  bool parse(const QString& headers);
+
+  /**
+   * @brief returns the number of columns
+   *
+   * @return int
+   */
+  int count() const { return m_count; }
+
+  /**
+   * @brief returns the JSON tag displayed at column
+   *
+   * @param column the column index
+   * @return QString empty if column is invalid
+   */
+  QString tag(int column) const { return (column >= 0 && column < m_tags.size()) ? m_tags.at(column) : QString(); }
+
+  /**
+   * @brief returns the header display name of column
+   *
+   * @param column the column index
+   * @return QString empty if column is invalid
+   */
+  QString name(int column) const { return (column >= 0 && column < m_names.size()) ? m_names.at(column) : QString(); }
+
+  /**
+   * @brief returns whether column is a custom drawn column (":draw" header option)
+   *
+   * @param column the column index
+   * @return bool
+   */
+  bool isDrawn(int column) const { return (column >= 0 && column < m_draw.size()) ? m_draw.at(column) : false; }
+
+  /**
+   * @brief returns the column index by header display name, JSON tag or index string
+   *
+   * @param key the name, tag or index string
+   * @return int -1 if not found
+   */
+  int column(const QString& key) const { return m_lookup.value(key,-1); }
+
+  /**
+   * @brief returns the descriptor in the hash format used by QJsonTreeItem::headers()
+   *
+   * @return QHash<QString, QHash<QString, QVariant> >
+   */
+  QHash<QString, QHash<QString, QVariant> > toHash() const;
+
+private:
+  int m_count;
+  QVector<QString> m_tags;
+  QVector<QString> m_names;
+  QVector<bool> m_draw;
+  QHash<QString, int> m_lookup;
+};
+
+#endif // QJSONTREEHEADERS_H
@@ -1,451 +1,738 @@
-/*
-    This file is part of QJsonTreeWidget.
-
-    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
-
-    QJsonTreeWidget is free software: you can redistribute it and/or modify
-    it under the terms of the GNU General Public License as published by
-    the Free Software Foundation, either version 3 of the License, or
-    (at your option) any later version.
-
-    QJsonTreeWidget is distributed in the hope that it will be useful,
-    but WITHOUT ANY WARRANTY; without even the implied warranty of
-    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-    GNU General Public License for more details.
-
-    You should have received a copy of the GNU General Public License
-    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
- */
-
-#include "qjsontreeitem.h"
-#include "qjsontreewidget.h"
-
-QHash<QString,Qt::ItemFlags> QJsonTreeItem::widgetFlags;
-QStringList QJsonTreeItem::descriptiveTags;
-
-QJsonTreeItem::QJsonTreeItem (QJsonTreeWidget* tree, QJsonTreeItem *parent, const QVariantMap &map, bool ignoreheaders)
-{
-  m_headersCount = 0;
-  m_widget = 0;
-  m_error = QJsonTreeItem::JsonNoError;
-  m_parent = parent;
-  m_widget = tree;
-  m_map = map;
-  m_backgroundColor = QColor();
-  m_foregroundColor = QColor();
-  m_font = QFont();
-  m_fontValid = false;
-  m_children = QList<QJsonTreeItem*>();
-
-  // this is done only once
-  if (QJsonTreeItem::widgetFlags.isEmpty())
-    QJsonTreeItem::buildWidgetFlags();
-  if (QJsonTreeItem::descriptiveTags.isEmpty())
-    QJsonTreeItem::buildDescriptiveTags();
-
-  // just create an empty item ?
-  if (map.isEmpty())
-    return;
-
-  // create item from map
-  fromMap(map,parent,ignoreheaders);
-}
-
-bool QJsonTreeItem::fromMap(const QVariantMap &map, QJsonTreeItem *parent,bool ignoreheaders)
-{
-  m_parent = parent;
-  m_map = map;
-
-  if (parent == 0)
-  {
-    m_root = this;
-
-    // this is the root item, must have "_headers_" set, store headers descriptor in m_headers
-    if (!setColumnHeaders(map.value("_headers_",QString()).toString()) && !ignoreheaders)
-    {
-      m_error = QJsonTreeItem::JsonMissingOrInvalidHeaders;
-      m_invalidMap = m_map;
-
-      // this invalidates the root map too
-      m_root->m_error = m_error;
-      m_root->m_invalidMap = m_invalidMap;
-      return false;
-    }
-  }
-  else
-  {
-    m_headers = parent->headers();
-    m_root = parent->rootItem();
-    m_headersCount = parent->columnCount();
-    m_totalTreeItems = parent->totalTreeItems();
-  }
-
-  // this is to optimize model index() function
-  foreach (QString k, m_map.keys())
-  {
-    if (k.contains("_readonly_"))
-    {
-      // add this value, this will be checked for special flag ReadOnlyHidesRow
-      m_map["__hasROSet__"] = m_map[k];
-      break;
-    }
-  }
-
-  if (m_map.contains("_children_"))
-  {
-    QVariantList l = m_map["_children_"].toList();
-    foreach (QVariant mm, l)
-    {
-      // recurse
-      QJsonTreeItem* i = new QJsonTreeItem(this->widget(),this,mm.toMap());
-      this->appendChild(i);
-    }
-  }
-
-  // strip "_children_" (to not waste memory, on save we use the tree structure to regenerate it)
-  m_map.remove("_children_");
-  m_error = QJsonTreeItem::JsonNoError;
-
-  return true;
-}
-
-QJsonTreeItem::~QJsonTreeItem()
-{
-  this->clear();
-}
-
-void QJsonTreeItem::appendChild(QJsonTreeItem *child)
-{
-  m_children.append(child);
-  m_root->m_totalTreeItems++;
-}
-
-void QJsonTreeItem::removeChild(int row)
-{
-  QJsonTreeItem* it = this->child(row);
-  m_children.removeAt(row);
-  delete it;
-  m_root->m_totalTreeItems--;
-}
-
-int QJsonTreeItem::totalChildCount() const
-{
-  int rowabs = this->rowAbsolute();
-  return (m_root->m_totalTreeItems - rowabs);
-}
-
-bool QJsonTreeItem::setColumnHeaders (const QString& columns)
-{
-  m_headers.clear();
-
-  // split columns string
-  QStringList l = columns.split(",");
-  if (l.isEmpty())
-  {
-    // something wrong, "_headers_" empty/missing
-    return false;
-  }
-  m_headersCount = l.count();
-
-  foreach (QString s, l)
-  {
-    QStringList sl = s.split(":");
-    QHash <QString,QVariant>h;
-
-    if (sl.count() < 3)
-    {
-      // something wrong in the "_headers_" tag,
-      return false;
-    }
-
-    // save name, jsontag and header idx in an hash
-    h["__name__"]=sl.at(0);
-    h["__tag__"]=sl.at(1);
-    h["__idx__"]=sl.at(2).toInt();
-    if (sl.count() == 4)
-    {
-      // this column item need to be drawn. there must be an option at the corresponding item map with i.e. tag=QPushButton,buttontext
-      h["__draw__"]=(sl.at(3).compare("draw",Qt::CaseInsensitive) == 0) ? true:false;
-    }
-
-    // use the same values as keys in the parent hash
-    m_headers[sl.at(0)] = h;
-    m_headers[sl.at(1)] = h;
-    m_headers[sl.at(2)] = h;
-  }
-  return true;
-}
-
-const QString QJsonTreeItem::headerNameOrTagByInt(int column, bool returntag) const
-{
-  QHash <QString, QVariant> h = headerHashByIdx(column);
-  if (h.isEmpty())
-    return QString();
-
-  if (returntag)
-    return h["__tag__"].toString();
-  return h["__name__"].toString();
-}
-
-const QString QJsonTreeItem::headerNameOrTagByString (const QString &name, bool returntag, int* column) const
-{
-  if (column)
-    *column = -1;
-
-  QHash <QString, QVariant> h = headerHashByName(name);
-  if (h.isEmpty())
-    return QString();
-
-  if (column)
-    *column = h["__idx__"].toInt();
-
-  if (returntag)
-    return h["__tag__"].toString();
-  return h["__name__"].toString();
-}
-
-const QString QJsonTreeItem::headerTagByIdx(int column) const
-{
-  return headerNameOrTagByInt(column,true);
-}
-
-const QString QJsonTreeItem::headerTagByName(const QString &name, int* column) const
-{
-  return headerNameOrTagByString(name,true,column);
-}
-
-const QString QJsonTreeItem::headerNameByIdx(int column) const
-{
-  return headerNameOrTagByInt(column,false);
-}
-
-const QString QJsonTreeItem::headerNameByTag(const QString &tag, int *column) const
-{
-  return headerNameOrTagByString(tag,false,column);
-}
-
-int QJsonTreeItem::headerIdxByTag(const QString &tag) const
-{
-  QHash <QString, QVariant> h = m_headers.value(tag,QHash<QString,QVariant>());
-  if (h.isEmpty())
-    return -1;
-  return h["__idx__"].toInt();
-}
-
-int QJsonTreeItem::headerIdxByName(const QString &name) const
-{
-  return headerIdxByTag(name); // since we have the name too as key in the parent hash, this will work
-}
-
-QString QJsonTreeItem::text(int column) const
-{
-  QString tag = headerTagByIdx(column);
-  return m_map.value(tag,QString()).toString();
-}
-
-bool QJsonTreeItem::validateRegexp(QString* nonmatchingcol, QString* nonmatchingname, QString* nonmatchingval) const
-{
-  for (int i=0; i < this->columnCount(); i++)
-  {
-    // check if we have a regexp set
-    QString tag = headerTagByIdx(i);
-    QRegExp rx = QRegExp(m_map.value("_regexp_:" % tag,QString()).toString());
-    if (rx.isEmpty())
-      continue;
-
-    QString val = m_map.value(tag,QString()).toString();
-    if (!rx.exactMatch(val))
-    {
-      *nonmatchingcol = headerNameByIdx(i);
-      *nonmatchingname = m_map.value("name",QString()).toString();
-      *nonmatchingval = val;
-      return false;
-    }
-  }
-  return true;
-}
-
-bool QJsonTreeItem::isTree() const
-{
-  foreach (QString k, m_map.keys())
-  {
-    if (k.contains("_widget_:"))
-    {
-      if (m_map[k].toString().compare("Tree",Qt::CaseInsensitive) == 0)
-        return true;
-    }
-  }
-  return false;
-}
-
-int QJsonTreeItem::depth() const
-{
-  int d = 0;
-  const QJsonTreeItem* it = this;
-  while (it->hasParent())
-  {
-    d++;
-    it = it->parent();
-  }
-  return d;
-}
-
-int QJsonTreeItem::row() const
-{
-  // if there's a parent item, this item's corresponding row is taken from the childs index of its parent. either, its the 1st row (row 0, this is a parent item)
-  QJsonTreeItem* parent = this->parent();
-  if (parent)
-    return (parent->children().indexOf(const_cast<QJsonTreeItem*>(this)));
-  return 0;
-}
-
-int QJsonTreeItem::rowAbsolute() const
-{
-  if (!this->parent())
-  {
-    // this is the tree root item, row 0
-    return 0;
-  }
-
-  // this item relative row
-  int n = row();
-  QJsonTreeItem* parent = this->parent()->parent();
-  while (parent)
-  {
-    // add this parent's parent childs
-    n+=parent->childCount();
-    parent = parent->parent();
-  }
-  return n;
-}
-
-void QJsonTreeItem::clear()
-{
-  qDeleteAll(m_children);
-  m_children.clear();
-}
-
-void QJsonTreeItem::buildWidgetFlags()
-{
-  // populate the hash with flags appropriate for the item, this will be read by the model
-  QJsonTreeItem::widgetFlags["Tree"] = (Qt::NoItemFlags);
-  QJsonTreeItem::widgetFlags["QCheckBox"]=(Qt::ItemIsEditable|Qt::ItemIsUserCheckable);
-  QJsonTreeItem::widgetFlags["QComboBox"]=(Qt::ItemIsEditable);
-  QJsonTreeItem::widgetFlags["QLineEdit"]=(Qt::ItemIsEditable);
-  QJsonTreeItem::widgetFlags["QPushButton"]= (Qt::NoItemFlags);
-  QJsonTreeItem::widgetFlags["QSpinBox"]=(Qt::ItemIsEditable);
-}
-
-void QJsonTreeItem::buildDescriptiveTags()
-{
-  // populate the list with descriptive tags
-  QJsonTreeItem::descriptiveTags.append("_widget_");
-  QJsonTreeItem::descriptiveTags.append("_headers_");
-  QJsonTreeItem::descriptiveTags.append("_desc_");
-  QJsonTreeItem::descriptiveTags.append("_valuemin_");
-  QJsonTreeItem::descriptiveTags.append("_valuemax_");
-  QJsonTreeItem::descriptiveTags.append("_valuelist_");
-  QJsonTreeItem::descriptiveTags.append("_regexp_");
-  QJsonTreeItem::descriptiveTags.append("_readonly_");
-  QJsonTreeItem::descriptiveTags.append("_hide_");
-  QJsonTreeItem::descriptiveTags.append("_template_");
-  QJsonTreeItem::descriptiveTags.append("_mandatory_");
-}
-
-void QJsonTreeItem::setMapValue(int column, const QVariant &value)
-{
-  QString tag = headerTagByIdx(column);
-  setMapValue(tag,value);
-}
-
-QVariantMap QJsonTreeItem::toMap(int depth, QVariantMap intmap, QJsonTreeItem* item) const
-{
-  const QJsonTreeItem* it;
-  if (depth == 0)
-  {
-    // first call
-    intmap = m_map;
-    it = this;
-  }
-  else
-  {
-    it = item;
-    intmap = it->map();
-  }
-
-  // this was added for optimization when building the tree
-  intmap.remove("__hasROSet__");
-  bool returnempty = false;
-
-  // check items to be purged
-  QHash<QString,bool> purgelist = it->widget()->purgeListOnSave();
-  if (!purgelist.isEmpty())
-  {
-    foreach (QString k, intmap.keys())
-    {
-      if (purgelist.contains(k))
-      {
-        if (purgelist.value(k,false) == true)
-        {
-          // strip the item completely
-          returnempty = true;
-        }
-        else
-        {
-          // just remove the tag
-          intmap.remove(k);
-        }
-      }
-    }
-  }
-  if (returnempty)
-    return QVariantMap();
-
-  // strip descriptive tags ?
-  QVariantMap newmap = intmap;
-  if (it->widget()->purgeDescriptiveTags())
-  {
-    foreach (QString k, QJsonTreeItem::descriptiveTags)
-    {
-      foreach (QString kk, intmap.keys())
-      {
-        if (kk.startsWith(k,Qt::CaseInsensitive))
-        {
-          newmap.remove(kk);
-        }
-      }
-    }
-  }
-  intmap = newmap;
-
-  if (it->childCount() > 0)
-  {
-    QVariantList l;
-    foreach (QJsonTreeItem* i, it->children())
-    {
-      // recurse
-      depth++;
-      QVariantMap mm = i->toMap(depth,intmap,i);
-      if (!mm.isEmpty())
-      {
-          l.append(mm);
-      }
-      depth--;
-    }
-
-    // add list as child
-    intmap["_children_"] = l;
-  }
-
-  return intmap;
-}
-
-QJsonTreeModel* QJsonTreeItem::model()
-{
-  return m_widget->model();
-}
-
-QTreeView* QJsonTreeItem::view()
-{
-  return m_widget->view();
-}
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qjsontreeitem.h"
+#include "qjsontreewidget.h"
+
+QHash<QString,QJsonTreeItem::WidgetType> QJsonTreeItem::widgetTypes;
+QStringList QJsonTreeItem::descriptiveTags;
+
+QJsonTreeItem::QJsonTreeItem (QJsonTreeWidget* tree, QJsonTreeItem *parent, const QVariantMap &map, bool ignoreheaders)
+{
+  m_totalTreeItems = 0;
+  m_row = 0;
+  m_attributes = 0;
+  m_widget = 0;
+  m_error = QJsonTreeItem::JsonNoError;
+  m_parent = parent;
+  m_root = 0;
+  m_widget = tree;
+  m_map = map;
+  m_children = QList<QJsonTreeItem*>();
+
+  // this is done only once
+  QJsonTreeItem::buildStaticTables();
+
+  // just create an empty item ?
+  if (map.isEmpty())
+    return;
+
+  // create item from map
+  fromMap(map,parent,ignoreheaders);
+}
+
+bool QJsonTreeItem::fromMap(const QVariantMap &map, QJsonTreeItem *parent,bool ignoreheaders)
+{
+  m_parent = parent;
+  m_map = map;
+
+  if (parent == 0)
+  {
+    m_root = this;
+
+    // this is the root item, must have "_headers_" set, store headers descriptor in m_headers
+    if (!setColumnHeaders(map.value("_headers_",QString()).toString()) && !ignoreheaders)
+    {
+      m_error = QJsonTreeItem::JsonMissingOrInvalidHeaders;
+      m_invalidMap = m_map;
+
+      // this invalidates the root map too
+      m_root->m_error = m_error;
+      m_root->m_invalidMap = m_invalidMap;
+      return false;
+    }
+  }
+  else
+  {
+    inheritFromParent(parent);
+  }
+
+  setItemMap(map);
+
+  if (m_map.contains("_children_"))
+  {
+    QVariantList l = m_map["_children_"].toList();
+    if (lazyLoading())
+    {
+      // children are materialized on demand by fetchMore()
+      m_pendingChildren = l;
+    }
+    else
+    {
+      foreach (QVariant mm, l)
+      {
+        // recurse
+        QJsonTreeItem* i = new (arena()) QJsonTreeItem(this->widget(),this,mm.toMap());
+        this->appendChild(i);
+      }
+    }
+  }
+
+  // strip "_children_" (to not waste memory, on save we use the tree structure to regenerate it)
+  m_map.remove("_children_");
+  m_error = QJsonTreeItem::JsonNoError;
+
+  return true;
+}
+
+void QJsonTreeItem::inheritFromParent(QJsonTreeItem *parent)
+{
+  m_parent = parent;
+  m_headers = parent->m_headers;
+  m_root = parent->rootItem();
+  m_totalTreeItems = parent->totalTreeItems();
+}
+
+void QJsonTreeItem::setItemMap(const QVariantMap &map)
+{
+  m_map = map;
+  updateAttributes();
+  updateSearchIndex();
+}
+
+void QJsonTreeItem::updateSearchIndex()
+{
+  // only items already in the index (so, owned by the GUI thread) are reindexed
+  if ((m_attributes & AttrIndexed) && m_widget)
+    m_widget->model()->searchIndex()->addItem(this);
+}
+
+void QJsonTreeItem::updateAttributes()
+{
+  // this is to optimize the model/proxy functions, which are called for each cell: special tags are looked up here only once
+  m_attributes &= (AttrStyled | AttrIndexed);
+  m_render.clear();
+  m_columnAttributes.fill(0,columnCount());
+  bool rofound = false;
+  for (QVariantMap::const_iterator it = m_map.constBegin(); it != m_map.constEnd(); ++it)
+  {
+    const QString& k = it.key();
+    if (!rofound && k.contains("_readonly_"))
+    {
+      // the first one found is checked for special flag ReadOnlyHidesRow
+      rofound = true;
+      if (it.value().toBool())
+        m_attributes |= AttrReadOnlySet;
+    }
+    if (!k.startsWith('_'))
+      continue;
+
+    if (k == "_hide_")
+    {
+      if (it.value().toBool())
+        m_attributes |= AttrRowHidden;
+      continue;
+    }
+    if (k == "_template_")
+    {
+      if (it.value().toBool())
+        m_attributes |= AttrTemplate;
+      continue;
+    }
+
+    uchar attr = 0;
+    QString tag;
+    if (k.startsWith("_widget_:"))
+    {
+      WidgetType type = widgetTypeByName(it.value().toString());
+      if (type == WidgetTree)
+        m_attributes |= AttrTree;
+      attr = type;
+      tag = k.mid(9);
+    }
+    else if (k.startsWith("_hide_:"))
+    {
+      attr = (it.value().toBool() ? ColAttrHidden : 0);
+      tag = k.mid(7);
+    }
+    else if (k.startsWith("_readonly_:"))
+    {
+      attr = ColAttrReadOnlyPresent | (it.value().toBool() ? ColAttrReadOnly : 0);
+      tag = k.mid(11);
+    }
+    else
+      continue;
+
+    // apply to the column displaying tag, if any
+    int column = headerIdxByTag(tag);
+    if (column >= 0 && column < m_columnAttributes.size() && m_headers->tag(column) == tag)
+      m_columnAttributes[column] = (char)(m_columnAttributes.at(column) | attr);
+  }
+}
+
+void QJsonTreeItem::attachSubtree(QJsonTreeItem *parent)
+{
+  // the item has been built detached (i.e. by QJsonTreeStreamReader) before its root was known, connect it now
+  inheritFromParent(parent);
+
+  // columns are known only now
+  updateAttributes();
+  foreach (QJsonTreeItem* c, m_children)
+  {
+    // recurse, counting the child as appendChild() would have done
+    c->attachSubtree(this);
+    m_root->m_totalTreeItems++;
+  }
+}
+
+QJsonTreeItem::~QJsonTreeItem()
+{
+  if ((m_attributes & AttrStyled) && m_widget)
+    m_widget->model()->removeItemStyle(this);
+  if ((m_attributes & AttrIndexed) && m_widget)
+    m_widget->model()->searchIndex()->removeItem(this);
+  if (m_widget && m_widget->model()->hasBatchChanges())
+    m_widget->model()->removeBatchChange(this);
+  this->clear();
+}
+
+void QJsonTreeItem::setBackgroundColor(const QColor &color)
+{
+  QJsonTreeItemStyle* s = itemStyle(true);
+  if (s)
+    s->backgroundColor = color;
+}
+
+QColor QJsonTreeItem::backgroundColor() const
+{
+  const QJsonTreeItemStyle* s = itemStyle();
+  return s ? s->backgroundColor : QColor();
+}
+
+void QJsonTreeItem::setForegroundColor(const QColor &color)
+{
+  QJsonTreeItemStyle* s = itemStyle(true);
+  if (s)
+    s->foregroundColor = color;
+}
+
+QColor QJsonTreeItem::foregroundColor() const
+{
+  const QJsonTreeItemStyle* s = itemStyle();
+  return s ? s->foregroundColor : QColor();
+}
+
+void QJsonTreeItem::setFont(const QFont &font)
+{
+  QJsonTreeItemStyle* s = itemStyle(true);
+  if (s)
+  {
+    s->font = font;
+    s->fontValid = true;
+  }
+}
+
+QFont QJsonTreeItem::font() const
+{
+  const QJsonTreeItemStyle* s = itemStyle();
+  return s ? s->font : QFont();
+}
+
+bool QJsonTreeItem::isFontValid() const
+{
+  const QJsonTreeItemStyle* s = itemStyle();
+  return s ? s->fontValid : false;
+}
+
+QJsonTreeItemStyle* QJsonTreeItem::itemStyle(bool create) const
+{
+  // styles are rarely set, they're kept by the model in a table instead of in each item
+  if (!(m_attributes & AttrStyled) && !create)
+    return 0;
+  if (!m_widget)
+    return 0;
+
+  if (create)
+    const_cast<QJsonTreeItem*>(this)->m_attributes |= AttrStyled;
+  return m_widget->model()->itemStyle(this,create);
+}
+
+void QJsonTreeItem::appendChild(QJsonTreeItem *child)
+{
+  child->m_row = m_children.count();
+  m_children.append(child);
+
+  // detached items (being built by QJsonTreeStreamReader) are counted by attachSubtree()
+  if (m_root)
+    m_root->m_totalTreeItems++;
+}
+
+void QJsonTreeItem::insertChild(int row, QJsonTreeItem *child)
+{
+  if (row < 0 || row >= m_children.count())
+  {
+    appendChild(child);
+    return;
+  }
+
+  m_children.insert(row,child);
+  renumberChildren(row);
+  if (m_root)
+    m_root->m_totalTreeItems++;
+}
+
+void QJsonTreeItem::insertChildren(int row, const QList<QJsonTreeItem *> &children)
+{
+  if (children.isEmpty())
+    return;
+  if (row < 0 || row > m_children.count())
+    row = m_children.count();
+
+  // the following siblings are moved once
+  if (row == m_children.count())
+    m_children.append(children);
+  else
+    m_children = m_children.mid(0,row) + children + m_children.mid(row);
+  renumberChildren(row);
+
+  // detached items (being built by QJsonTreeStreamReader) are counted by attachSubtree()
+  if (m_root)
+    m_root->m_totalTreeItems += children.count();
+}
+
+void QJsonTreeItem::removeChildren(int row, int count)
+{
+  if (row < 0 || row >= m_children.count() || count <= 0)
+    return;
+  count = qMin(count,m_children.count() - row);
+
+  QList<QJsonTreeItem*> removed = m_children.mid(row,count);
+  m_children.erase(m_children.begin() + row,m_children.begin() + row + count);
+  renumberChildren(row);
+  qDeleteAll(removed);
+  m_root->m_totalTreeItems -= count;
+}
+
+void QJsonTreeItem::removeChild(int row)
+{
+  QJsonTreeItem* it = this->child(row);
+  m_children.removeAt(row);
+  renumberChildren(row);
+  delete it;
+  m_root->m_totalTreeItems--;
+}
+
+void QJsonTreeItem::renumberChildren(int from)
+{
+  // only the siblings following a change need their row updated
+  for (int i=from; i < m_children.count(); i++)
+  {
+    m_children.at(i)->m_row = i;
+  }
+}
+
+int QJsonTreeItem::fetchMore(int count)
+{
+  int n = 0;
+  while (n < count && !m_pendingChildren.isEmpty())
+  {
+    // this builds the child, whose own children are kept pending in turn
+    QJsonTreeItem* i = new (arena()) QJsonTreeItem(this->widget(),this,m_pendingChildren.takeFirst().toMap());
+    this->appendChild(i);
+    n++;
+  }
+  return n;
+}
+
+bool QJsonTreeItem::lazyLoading() const
+{
+  return (m_widget && m_widget->lazyLoadingEnabled());
+}
+
+int QJsonTreeItem::totalChildCount() const
+{
+  int rowabs = this->rowAbsolute();
+  return (m_root->m_totalTreeItems - rowabs);
+}
+
+bool QJsonTreeItem::setColumnHeaders (const QString& columns)
+{
+  // built once here, then shared by all the items
+  m_headers = new QJsonTreeHeaders();
+  return m_headers->parse(columns);
+}
+
+const QString QJsonTreeItem::headerNameOrTagByInt(int column, bool returntag) const
+{
+  if (!m_headers)
+    return QString();
+
+  if (returntag)
+    return m_headers->tag(column);
+  return m_headers->name(column);
+}
+
+const QString QJsonTreeItem::headerNameOrTagByString (const QString &name, bool returntag, int* column) const
+{
+  if (column)
+    *column = -1;
+
+  int idx = headerIdxByTag(name);
+  if (idx == -1)
+    return QString();
+
+  if (column)
+    *column = idx;
+
+  if (returntag)
+    return m_headers->tag(idx);
+  return m_headers->name(idx);
+}
+
+const QString QJsonTreeItem::headerTagByIdx(int column) const
+{
+  return headerNameOrTagByInt(column,true);
+}
+
+const QString QJsonTreeItem::headerTagByName(const QString &name, int* column) const
+{
+  return headerNameOrTagByString(name,true,column);
+}
+
+const QString QJsonTreeItem::headerNameByIdx(int column) const
+{
+  return headerNameOrTagByInt(column,false);
+}
+
+const QString QJsonTreeItem::headerNameByTag(const QString &tag, int *column) const
+{
+  return headerNameOrTagByString(tag,false,column);
+}
+
+int QJsonTreeItem::headerIdxByTag(const QString &tag) const
+{
+  if (!m_headers)
+    return -1;
+  return m_headers->column(tag);
+}
+
+int QJsonTreeItem::headerIdxByName(const QString &name) const
+{
+  return headerIdxByTag(name); // since we have the name too as key in the lookup hash, this will work
+}
+
+QString QJsonTreeItem::text(int column) const
+{
+  QString tag = headerTagByIdx(column);
+  return m_map.value(tag,QString()).toString();
+}
+
+bool QJsonTreeItem::validateRegexp(QString* nonmatchingcol, QString* nonmatchingname, QString* nonmatchingval) const
+{
+  for (int i=0; i < this->columnCount(); i++)
+  {
+    // check if we have a regexp set
+    QString tag = headerTagByIdx(i);
+    QRegExp rx = QRegExp(m_map.value("_regexp_:" % tag,QString()).toString());
+    if (rx.isEmpty())
+      continue;
+
+    QString val = m_map.value(tag,QString()).toString();
+    if (!rx.exactMatch(val))
+    {
+      *nonmatchingcol = headerNameByIdx(i);
+      *nonmatchingname = m_map.value("name",QString()).toString();
+      *nonmatchingval = val;
+      return false;
+    }
+  }
+  return true;
+}
+
+Qt::ItemFlags QJsonTreeItem::widgetTypeFlags(WidgetType type)
+{
+  // flags appropriate for the item, this will be read by the model
+  switch (type)
+  {
+    case WidgetCheckBox:
+      return (Qt::ItemIsEditable|Qt::ItemIsUserCheckable);
+    case WidgetComboBox:
+    case WidgetLineEdit:
+    case WidgetSpinBox:
+      return (Qt::ItemIsEditable);
+    default:
+      break;
+  }
+  return (Qt::NoItemFlags);
+}
+
+QJsonTreeItem::WidgetType QJsonTreeItem::widgetTypeByName(const QString &name)
+{
+  if (name.isEmpty())
+    return WidgetNone;
+  return QJsonTreeItem::widgetTypes.value(name.toLower(),WidgetUnknown);
+}
+
+int QJsonTreeItem::depth() const
+{
+  int d = 0;
+  const QJsonTreeItem* it = this;
+  while (it->hasParent())
+  {
+    d++;
+    it = it->parent();
+  }
+  return d;
+}
+
+int QJsonTreeItem::rowAbsolute() const
+{
+  if (!this->parent())
+  {
+    // this is the tree root item, row 0
+    return 0;
+  }
+
+  // this item relative row
+  int n = row();
+  QJsonTreeItem* parent = this->parent()->parent();
+  while (parent)
+  {
+    // add this parent's parent childs
+    n+=parent->childCount();
+    parent = parent->parent();
+  }
+  return n;
+}
+
+void QJsonTreeItem::clear()
+{
+  qDeleteAll(m_children);
+  m_children.clear();
+  m_pendingChildren.clear();
+}
+
+void QJsonTreeItem::buildStaticTables()
+{
+  // this is done only once. QJsonTreeWidget calls this on the GUI thread too, before any item is built by a loader thread
+  if (QJsonTreeItem::widgetTypes.isEmpty())
+    QJsonTreeItem::buildWidgetTypes();
+  if (QJsonTreeItem::descriptiveTags.isEmpty())
+    QJsonTreeItem::buildDescriptiveTags();
+}
+
+void QJsonTreeItem::buildWidgetTypes()
+{
+  // populate the hash with the supported widgets (lowercase, lookup is case insensitive)
+  QJsonTreeItem::widgetTypes["tree"] = WidgetTree;
+  QJsonTreeItem::widgetTypes["qcheckbox"] = WidgetCheckBox;
+  QJsonTreeItem::widgetTypes["qcombobox"] = WidgetComboBox;
+  QJsonTreeItem::widgetTypes["qlineedit"] = WidgetLineEdit;
+  QJsonTreeItem::widgetTypes["qpushbutton"] = WidgetPushButton;
+  QJsonTreeItem::widgetTypes["qspinbox"] = WidgetSpinBox;
+}
+
+void QJsonTreeItem::buildDescriptiveTags()
+{
+  // populate the list with descriptive tags
+  QJsonTreeItem::descriptiveTags.append("_widget_");
+  QJsonTreeItem::descriptiveTags.append("_headers_");
+  QJsonTreeItem::descriptiveTags.append("_desc_");
+  QJsonTreeItem::descriptiveTags.append("_valuemin_");
+  QJsonTreeItem::descriptiveTags.append("_valuemax_");
+  QJsonTreeItem::descriptiveTags.append("_valuelist_");
+  QJsonTreeItem::descriptiveTags.append("_regexp_");
+  QJsonTreeItem::descriptiveTags.append("_readonly_");
+  QJsonTreeItem::descriptiveTags.append("_hide_");
+  QJsonTreeItem::descriptiveTags.append("_template_");
+  QJsonTreeItem::descriptiveTags.append("_mandatory_");
+}
+
+void QJsonTreeItem::setMapValue(const QString &tag, const QVariant &value)
+{
+  m_map[tag] = value;
+  m_render.clear();
+
+  // special tags change the item attributes
+  if (tag.startsWith('_') || tag.contains("_readonly_"))
+    updateAttributes();
+  updateSearchIndex();
+}
+
+const QJsonTreeItemRender& QJsonTreeItem::renderDescriptor(int column) const
+{
+  static const QJsonTreeItemRender none;
+  if (m_render.isEmpty())
+  {
+    // resolve all the columns at once, the whole row is painted anyway
+    int cols = columnCount();
+    m_render.resize(cols);
+    for (int c=0; c < cols; c++)
+    {
+      QJsonTreeItemRender& r = m_render[c];
+      if (m_map.isEmpty())
+        continue;
+
+      // we always paint the checkbox
+      QString tag = headerTagByIdx(c);
+      if (widgetType(c) == WidgetCheckBox)
+      {
+        r.kind = QJsonTreeItemRender::CheckBox;
+        r.checked = m_map.value(tag,false).toBool();
+        continue;
+      }
+
+      // drawn columns hold a ,, separated string: 0:widget, 1:text, 2:optional pixmap
+      if (!headerIsDrawn(c))
+        continue;
+      QString val = m_map.value(tag,QVariant()).toString();
+      if (val.isEmpty())
+        continue;
+      QStringList l = val.split(",,");
+      r.kind = (widgetTypeByName(l.at(0)) == WidgetPushButton ? QJsonTreeItemRender::PushButton : QJsonTreeItemRender::Nothing);
+      r.text = (l.count() >= 2 ? l.at(1) : QString());
+      r.icon = (l.count() == 3 ? l.at(2) : QString());
+    }
+  }
+  if (column < 0 || column >= m_render.size())
+    return none;
+  return m_render.at(column);
+}
+
+void QJsonTreeItem::setMapValue(int column, const QVariant &value)
+{
+  QString tag = headerTagByIdx(column);
+  setMapValue(tag,value);
+}
+
+QVariantMap QJsonTreeItem::toMap() const
+{
+  QVariantMap intmap = m_map;
+  if (!purgeMap(&intmap))
+    return QVariantMap();
+
+  if (hasChildren())
+  {
+    QVariantList l;
+    foreach (QJsonTreeItem* i, m_children)
+    {
+      // recurse
+      QVariantMap mm = i->toMap();
+      if (!mm.isEmpty())
+      {
+          l.append(mm);
+      }
+    }
+
+    // children not materialized yet (lazy loading) are taken from their raw map
+    foreach (QVariant v, m_pendingChildren)
+    {
+      QVariantMap mm = rawToMap(v.toMap());
+      if (!mm.isEmpty())
+      {
+          l.append(mm);
+      }
+    }
+
+    // add list as child
+    intmap["_children_"] = l;
+  }
+
+  return intmap;
+}
+
+QVariantMap QJsonTreeItem::rawToMap(const QVariantMap &raw) const
+{
+  // same as toMap(), for a raw JSON object still containing its "_children_"
+  QVariantMap intmap = raw;
+  QVariantList children = intmap.take("_children_").toList();
+  if (!purgeMap(&intmap))
+    return QVariantMap();
+
+  if (!children.isEmpty())
+  {
+    QVariantList l;
+    foreach (QVariant v, children)
+    {
+      // recurse
+      QVariantMap mm = rawToMap(v.toMap());
+      if (!mm.isEmpty())
+      {
+          l.append(mm);
+      }
+    }
+    intmap["_children_"] = l;
+  }
+  return intmap;
+}
+
+bool QJsonTreeItem::purgeMap(QVariantMap *map) const
+{
+  // check items to be purged
+  QHash<QString,bool> purgelist = widget()->purgeListOnSave();
+  if (!purgelist.isEmpty())
+  {
+    bool returnempty = false;
+    foreach (QString k, map->keys())
+    {
+      if (purgelist.contains(k))
+      {
+        if (purgelist.value(k,false) == true)
+        {
+          // strip the item completely
+          returnempty = true;
+        }
+        else
+        {
+          // just remove the tag
+          map->remove(k);
+        }
+      }
+    }
+    if (returnempty)
+      return false;
+  }
+
+  // strip descriptive tags ?
+  if (widget()->purgeDescriptiveTags())
+  {
+    QStringList keys = map->keys();
+    foreach (QString k, QJsonTreeItem::descriptiveTags)
+    {
+      foreach (QString kk, keys)
+      {
+        if (kk.startsWith(k,Qt::CaseInsensitive))
+        {
+          map->remove(kk);
+        }
+      }
+    }
+  }
+  return true;
+}
+
+QJsonTreeModel* QJsonTreeItem::model()
+{
+  return m_widget->model();
+}
+
+QTreeView* QJsonTreeItem::view()
+{
+  return m_widget->view();
+}
@@ -1,413 +1,626 @@
-/*
-    This file is part of QJsonTreeWidget.
-
-    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
-
-    QJsonTreeWidget is free software: you can redistribute it and/or modify
-    it under the terms of the GNU General Public License as published by
-    the Free Software Foundation, either version 3 of the License, or
-    (at your option) any later version.
-
-    QJsonTreeWidget is distributed in the hope that it will be useful,
-    but WITHOUT ANY WARRANTY; without even the implied warranty of
-    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-    GNU General Public License for more details.
-
-    You should have received a copy of the GNU General Public License
-    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
- */
-
-#ifndef QJSONTREEITEM_H
-#define QJSONTREEITEM_H
-
-#include <QtCore>
-#include <QColor>
-#include <QFont>
-#include "qjsontree_global.h"
-
-class QJsonTreeModel;
-class QJsonTreeWidget;
-class QTreeView;
-class QJsonSortFilterProxyModel;
-class QJsonTreeItemDelegate;
-
-/**
- * @brief class to represent a tree item from a JSON object coming from QJsonTreeModel
- *
- */
- class QJSONTREE_EXPORT QJsonTreeItem
- {
-   friend class QJsonTreeModel;
-   friend class QJsonTreeWidget;
-   friend class QJsonSortFilterProxyModel;
-   friend class QJsonTreeItemDelegate;
-
-   public:
-
-   /**
-    * @brief  internal errors returned when building a QJsonTreeItem
-    *
-    */
-   enum JsonMapErrors {
-     JsonNoError = 0,
-     JsonInvalidMap = 1,
-     JsonMissingOrInvalidHeaders = 2
-   };
-
-   /**
-    * @brief various item special flags
-    *
-    */
-   enum SpecialFlag {
-     HonorReadOnly = 1,
-     HonorHide = 2,
-     ReadOnlyHidesRow = 4,
-     HonorItemBackgroundColor = 8,
-     HonorItemForegroundColor = 16,
-     HonorItemFont = 32,
-     HonorParentsBackgroundColor = 64,
-     HonorParentsForegroundColor = 128,
-     HonorParentsFont = 256,
-     HonorChildsBackgroundColor = 512,
-     HonorChildsForegroundColor = 1024,
-     HonorChildsFont = 2048,
-     HonorColumnBackgroundColor = 4096,
-     HonorColumnForegroundColor = 8192,
-     HonorColumnFont = 16384,
-     HonorAll = HonorReadOnly | HonorHide | HonorItemBackgroundColor | HonorItemForegroundColor | HonorItemFont | HonorParentsBackgroundColor | HonorParentsForegroundColor | HonorParentsFont |
-      HonorChildsBackgroundColor | HonorChildsForegroundColor | HonorChildsFont | HonorColumnBackgroundColor | HonorColumnForegroundColor | HonorColumnFont
-   };
-   Q_DECLARE_FLAGS (SpecialFlags, SpecialFlag)
-
-/**
-  * @brief constructor
-  *
-  * @param tree : the QJsonTreeWidget this item belongs to
-  * @param parent : the item parent (optional)
-  * @param map: the item data as a map coming from QJson (optional)
-  * @param ignoreheaders: set to true if you're constructing a spare item (to not be connected to a tree)
-  */
-   QJsonTreeItem (QJsonTreeWidget* tree, QJsonTreeItem *parent = 0, const QVariantMap &map = QVariantMap(), bool ignoreheaders=false);
-
-   /**
-    * @brief fills an item from a QJson map, replacing previous content
-    *
-    * @param map: the item data as a map coming from QJson
-    * @param parent : the item parent (optional)
-    * @param ignoreheaders: set to true if you're constructing a spare item (to not be connected to a tree)
-    * @return bool
-    */
-   bool fromMap(const QVariantMap &map, QJsonTreeItem *parent = 0, bool ignoreheaders=false);
-
-   /**
-    * @brief destructor
-    *
-    */
-   virtual ~QJsonTreeItem();
-
-   /**
-    * @brief adds a child node to this item
-    *
-    * @param child the child item
-    */
-   void appendChild(QJsonTreeItem *child);
-
-   /**
-    * @brief returns the item at the specified row in the tree view
-    *
-    * @param row the row number
-    * @return QJsonTreeItem
-    */
-   QJsonTreeItem* child(int row) const { return m_children.value(row); }
-
-   /**
-    * @brief removes the specified child from the internal list. the corresponding QJsonTreeItem* is deleted too.
-    *
-    * @param row the row number (= the nth child)
-    */
-   void removeChild (int row);
-
-   /**
-    * @brief returns this item's children
-    *
-    * @return QList<QJsonTreeItem *>
-    */
-   QList<QJsonTreeItem*> children() const { return m_children; }
-
-   /**
-    * @brief returns whether this item has children or not
-    *
-    * @return bool
-    */
-   bool hasChildren() const { return !m_children.isEmpty(); }
-
-   /**
-    * @brief returns the number of childs this item has (= the number of rows for the parent item)
-    *
-    * @return int
-    */
-   int childCount() const { return m_children.count(); }
-
-   /**
-    * @brief returns the number of childs (recursive) this item has
-    *
-    * @return int
-    */
-   int totalChildCount() const;
-
-   /**
-    * @brief get the total number of items the root item has
-    *
-    * return int
-    */
-   int totalTreeItems() const { return m_root->m_totalTreeItems; }
-
-   /**
-    * @brief returns the number of tree columns this item is represented on (fixed, from JSON root map "_headers_" stored in the root item's columns descriptor)
-    *
-    * @return int
-    */
-   int columnCount() const { return m_headersCount; }
-
-   /**
-    * @brief returns columns description (with name,jsontag,idx).
-    * Note that this always returns a pointer to rootitem's headers descriptor (m_headers), since this is stored in the root only for optimization
-    *
-    * @return QList<QHash<QString, QVariant> >
-    */
-   const QHash<QString, QHash<QString, QVariant> > headers() const { return m_headers; }
-
-   /**
-    * @brief sets the whole internal item map for this item (replace the JSON object)
-    *
-    * @param map the new item map
-    */
-   void setMap (const QVariantMap& map) { m_map = map; }
-
-   /**
-    * @brief returns the whole internal map for this item
-    *
-    */
-   const QVariantMap map() const { return m_map; }
-
-   /**
-    * @brief sets a new value in the internal item map
-    *
-    * @param tag the JSON tag name
-    * @param value the new value
-    * @param applyto parameter for the tag (optional)
-    */
-   void setMapValue (const QString& tag, const QVariant& value) { m_map[tag] = value;}
-
-   /**
-    * @brief sets a new value in the internal item map
-    *
-    * @param int the header column index
-    * @param value the new value
-    * @param applyto parameter for the tag (optional)
-    */
-   void setMapValue (int column, const QVariant& value);
-
-   /**
-    * @brief recursively rebuilds the JSON map from the tree structure
-    *
-    * @param depth internal (always 0)
-    * @param intmap internal (always 0)
-    * @param item internal (always 0)
-    * @return QVariantMap
-    */
-   QVariantMap toMap(int depth=0, QVariantMap intmap = QVariantMap(), QJsonTreeItem* item = 0) const;
-
-   /**
-    * @brief returns the row at which this item is in the tree view, relative to its parent if any
-    *
-    * @return int
-    */
-   int row() const;
-
-   /**
-    * @brief returns the row at which this item is in the tree view, relative to the main root item
-    *
-    * @return int
-    */
-   int rowAbsolute() const;
-
-   /**
-    * @brief returns this item's parent
-    *
-    * @return QJsonTreeItem
-    */
-   QJsonTreeItem* parent() const { return m_parent; }
-
-   /**
-    * @brief returns whether this item has parent or not (if not, this is the root item)
-    *
-    * @return bool
-    */
-   bool hasParent() const { return (m_parent == 0 ? false : true); }
-
-   /**
-    * @brief returns the tree root item
-    *
-    * @return QJsonTreeItem
-    */
-   QJsonTreeItem* rootItem() const { return m_root; }
-
-   /**
-    * @brief returns wether the item has been constructed succesfully or not
-    *
-    * @return bool
-    */
-   bool isValid() const { return (m_error == QJsonTreeItem::JsonNoError); }
-
-   /**
-    * @brief returns an error defined in JsonMapErrors
-    *
-    * @return JsonMapErrors
-    */
-   QJsonTreeItem::JsonMapErrors error() const { return m_error; }
-
-   /**
-    * @brief this is a convenience function which returns the map causing the error.
-    * this will be useful usually only through rootItem()->invalidMap() in case of error during loadJson() from the model
-    *
-    * @return QVariantMap
-    */
-   QVariantMap invalidMap() const { return m_invalidMap; }
-
-   /**
-    * @brief completely clears the item deleting all its child items too. The item can then be reused by calling fromMap()
-    *
-    */
-   void clear();
-
-   /**
-    * @brief returns the QJsonTreeWidget this item belongs to
-    *
-    * @return QJsonTreeWidget
-    */
-   QJsonTreeWidget* widget() const { return m_widget; }
-
-   /**
-    * @brief returns the text at the specified column
-    *
-    * @param idx the column index
-    * @return QString
-    */
-   QString text(int column) const;
-
-   /**
-    * @brief returns true if all the _regexp_ defined in the item's map matches their assigned values, or false if it doesnt.
-    * it's valid only for items representing one or more QLineEdit and having one or more regexps set. if not, it returns true as default
-    *
-    * @param nonmatchingcol on false return, name of the first nonmatching column
-    * @param nonmatchingname on false return, name of the first nonmatching name
-    * @param nonmatchingval on false return, name of the first nonmatching value
-    * @return bool
-    */
-   bool validateRegexp(QString* nonmatchingcol, QString* nonmatchingname, QString* nonmatchingval) const;
-
-   /**
-    * @brief sets the background color for the item
-    *
-    * @param color the color to be set
-    */
-   void setBackgroundColor(const QColor& color) { m_backgroundColor = color; }
-
-   /**
-    * @brief returns the background color set for the item, if any
-    *
-    * @return QColor
-    */
-   QColor backgroundColor() const { return m_backgroundColor; }
-
-   /**
-    * @brief sets the foreground color for the item
-    *
-    * @param color the color to be set
-    */
-   void setForegroundColor (const QColor& color) {m_foregroundColor = color; }
-
-   /**
-    * @brief returns the foreground color set for the item, if any
-    *
-    * @return QColor
-    */
-   QColor foregroundColor () const { return m_foregroundColor; }
-
-   /**
-    * @brief sets the font for the item
-    *
-    * @param font the font to be set
-    */
-   void setFont (const QFont& font) { m_font = font; m_fontValid = true;}
-
-   /**
-    * @brief returns the font set for the item, if any
-    *
-    * @return QFont
-    */
-   QFont font() const { return m_font; }
-
-   /**
-    * @brief use this instead of hasChildren, for parents with no childrens
-    *
-    * @return bool
-    */
-   bool isTree() const;
-
-   /**
-    * @brief returns if the item has an initialized font set
-    *
-    * @return bool
-    */
-   bool isFontValid() const { return m_fontValid; }
-
-   /**
-    * @brief returns the item depth (0 for parents)
-    *
-    * @return int
-    */
-   int depth() const;
-
- protected:
-   QJsonTreeModel* model();
-   QTreeView *view();
-
- private:
-   static void buildWidgetFlags();
-   static void buildDescriptiveTags();
-   bool setColumnHeaders(const QString &headers);
-   const QString headerNameOrTagByString(const QString &name, bool returntag, int *column) const;
-   const QString headerNameOrTagByInt(int column, bool returntag) const;
-   const QString headerNameByIdx(int column) const;
-   const QString headerNameByTag (const QString& tag, int* column=0) const;
-   const QString headerTagByIdx (int column) const;
-   const QString headerTagByName (const QString& name, int* column=0) const;
-   int headerIdxByTag(const QString &tag) const;
-   int headerIdxByName(const QString &name) const;
-   const QHash<QString, QVariant> headerHashByIdx (int column) const { return m_headers.value(QVariant(column).toString(),QHash<QString,QVariant>()); }
-   const QHash<QString, QVariant> headerHashByTag (const QString& tag) const { return m_headers.value(tag,QHash<QString,QVariant>()); }
-   const QHash<QString, QVariant> headerHashByName (const QString& name) const { return m_headers.value(name,QHash<QString,QVariant>()); }
-   static QHash<QString, Qt::ItemFlags> widgetFlags;
-   static QStringList descriptiveTags;
-   QJsonTreeItem::JsonMapErrors m_error;
-   QModelIndex m_index;
-   QList<QJsonTreeItem*> m_children;
-   QVariantMap m_map;
-   QVariantMap m_invalidMap;
-   QJsonTreeItem* m_parent;
-   QJsonTreeItem* m_root;
-   QJsonTreeWidget* m_widget;
-   QColor m_backgroundColor;
-   QColor m_foregroundColor;
-   QFont m_font;
-   bool m_fontValid;
-   int m_headersCount; // m_headers.count() to return number of columns wouldnt work, since how we store data in such hash
-   int m_totalTreeItems;
-   QHash<QString, QHash<QString, QVariant> > m_headers;
- };
-
- Q_DECLARE_OPERATORS_FOR_FLAGS(QJsonTreeItem::SpecialFlags)
-
-#endif // QJSONTREEITEM_H
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QJSONTREEITEM_H
+#define QJSONTREEITEM_H
+
+#include <QtCore>
+#include <QColor>
+#include <QFont>
+#include "qjsontree_global.h"
+#include "qjsontreeheaders.h"
+#include "qjsontreeitemarena.h"
+
+class QJsonTreeModel;
+class QJsonTreeWidget;
+class QTreeView;
+class QJsonSortFilterProxyModel;
+class QJsonTreeItemDelegate;
+struct QJsonTreeItemStyle;
+
+/**
+ * @brief how QJsonTreeItemDelegate::paint() renders a cell, resolved from the item map once (until the item changes)
+ *
+ */
+struct QJsonTreeItemRender
+{
+  enum Kind {
+    Default = 0, // painted by QStyledItemDelegate
+    CheckBox, // "_widget_:tag" is QCheckBox
+    PushButton, // drawn column holding "QPushButton,,text,,pixmap"
+    Nothing // drawn column holding an unsupported control
+  };
+  QJsonTreeItemRender() { kind = Default; checked = false; }
+  int kind;
+  QString text;
+  QString icon; // the pixmap path
+  bool checked;
+};
+
+/**
+ * @brief class to represent a tree item from a JSON object coming from QJsonTreeModel
+ *
+ */
+ class QJSONTREE_EXPORT QJsonTreeItem
+ {
+   friend class QJsonTreeModel;
+   friend class QJsonTreeWidget;
+   friend class QJsonSortFilterProxyModel;
+   friend class QJsonTreeItemDelegate;
+   friend class QJsonTreeStreamReader;
+   friend class QJsonTreeStreamWriter;
+   friend class QJsonTreeSearchIndex;
+   friend class QJsonTreeQuery;
+
+   public:
+
+   /**
+    * @brief  internal errors returned when building a QJsonTreeItem
+    *
+    */
+   enum JsonMapErrors {
+     JsonNoError = 0,
+     JsonInvalidMap = 1,
+     JsonMissingOrInvalidHeaders = 2
+   };
+
+   /**
+    * @brief various item special flags
+    *
+    */
+   enum SpecialFlag {
+     HonorReadOnly = 1,
+     HonorHide = 2,
+     ReadOnlyHidesRow = 4,
+     HonorItemBackgroundColor = 8,
+     HonorItemForegroundColor = 16,
+     HonorItemFont = 32,
+     HonorParentsBackgroundColor = 64,
+     HonorParentsForegroundColor = 128,
+     HonorParentsFont = 256,
+     HonorChildsBackgroundColor = 512,
+     HonorChildsForegroundColor = 1024,
+     HonorChildsFont = 2048,
+     HonorColumnBackgroundColor = 4096,
+     HonorColumnForegroundColor = 8192,
+     HonorColumnFont = 16384,
+     HonorAll = HonorReadOnly | HonorHide | HonorItemBackgroundColor | HonorItemForegroundColor | HonorItemFont | HonorParentsBackgroundColor | HonorParentsForegroundColor | HonorParentsFont |
+      HonorChildsBackgroundColor | HonorChildsForegroundColor | HonorChildsFont | HonorColumnBackgroundColor | HonorColumnForegroundColor | HonorColumnFont
+   };
+   Q_DECLARE_FLAGS (SpecialFlags, SpecialFlag)
+
+   /**
+    * @brief widget types set through "_widget_:JSONtag"
+    *
+    */
+   enum WidgetType {
+     WidgetNone = 0,
+     WidgetTree = 1,
+     WidgetCheckBox = 2,
+     WidgetComboBox = 3,
+     WidgetLineEdit = 4,
+     WidgetPushButton = 5,
+     WidgetSpinBox = 6,
+     WidgetUnknown = 7
+   };
+
+/**
+  * @brief constructor
+  *
+  * @param tree : the QJsonTreeWidget this item belongs to
+  * @param parent : the item parent (optional)
+  * @param map: the item data as a map coming from QJson (optional)
+  * @param ignoreheaders: set to true if you're constructing a spare item (to not be connected to a tree)
+  */
+   QJsonTreeItem (QJsonTreeWidget* tree, QJsonTreeItem *parent = 0, const QVariantMap &map = QVariantMap(), bool ignoreheaders=false);
+
+   /**
+    * @brief fills an item from a QJson map, replacing previous content
+    *
+    * @param map: the item data as a map coming from QJson
+    * @param parent : the item parent (optional)
+    * @param ignoreheaders: set to true if you're constructing a spare item (to not be connected to a tree)
+    * @return bool
+    */
+   bool fromMap(const QVariantMap &map, QJsonTreeItem *parent = 0, bool ignoreheaders=false);
+
+   /**
+    * @brief destructor
+    *
+    */
+   virtual ~QJsonTreeItem();
+
+   /**
+    * @brief allocates the item from the heap
+    *
+    */
+   static void* operator new(size_t size) { return QJsonTreeItemArena::allocate(size); }
+
+   /**
+    * @brief allocates the item from a document arena (new (arena) QJsonTreeItem(...)), see QJsonTreeItemArena
+    *
+    */
+   static void* operator new(size_t size, QJsonTreeItemArena* arena) { return QJsonTreeItemArena::allocate(size,arena); }
+
+   /**
+    * @brief releases the item memory, to the heap or to its arena
+    *
+    */
+   static void operator delete(void* p) { QJsonTreeItemArena::release(p); }
+   static void operator delete(void* p, QJsonTreeItemArena* arena) { Q_UNUSED(arena); QJsonTreeItemArena::release(p); }
+
+   /**
+    * @brief returns the arena this item has been allocated from (children built by the library are allocated from the parent arena)
+    *
+    * @return QJsonTreeItemArena 0 if the item has been allocated from the heap
+    */
+   QJsonTreeItemArena* arena() const { return QJsonTreeItemArena::arenaOf(this); }
+
+   /**
+    * @brief adds a child node to this item
+    *
+    * @param child the child item
+    */
+   void appendChild(QJsonTreeItem *child);
+
+   /**
+    * @brief inserts a child node to this item at the specified row
+    *
+    * @param row the row number (= the nth child), if out of range the child is appended
+    * @param child the child item
+    */
+   void insertChild(int row, QJsonTreeItem *child);
+
+   /**
+    * @brief inserts child nodes to this item at the specified row, in a single list operation
+    *
+    * @param row the row number of the first child, if out of range the children are appended
+    * @param children the children items, in order
+    */
+   void insertChildren(int row, const QList<QJsonTreeItem*>& children);
+
+   /**
+    * @brief returns the item at the specified row in the tree view
+    *
+    * @param row the row number
+    * @return QJsonTreeItem
+    */
+   QJsonTreeItem* child(int row) const { return m_children.value(row); }
+
+   /**
+    * @brief removes the specified child from the internal list. the corresponding QJsonTreeItem* is deleted too.
+    *
+    * @param row the row number (= the nth child)
+    */
+   void removeChild (int row);
+
+   /**
+    * @brief removes count children from row on, in a single list operation. the corresponding QJsonTreeItem* are deleted too.
+    *
+    * @param row the row number of the first child
+    * @param count number of children to remove (clamped to the existing ones)
+    */
+   void removeChildren (int row, int count);
+
+   /**
+    * @brief returns this item's children
+    *
+    * @return QList<QJsonTreeItem *>
+    */
+   QList<QJsonTreeItem*> children() const { return m_children; }
+
+   /**
+    * @brief returns whether this item has children or not (including children not yet materialized in lazy loading mode)
+    *
+    * @return bool
+    */
+   bool hasChildren() const { return (!m_children.isEmpty() || !m_pendingChildren.isEmpty()); }
+
+   /**
+    * @brief returns the number of childs this item has (= the number of rows for the parent item). in lazy loading mode, only the materialized children are counted
+    *
+    * @return int
+    */
+   int childCount() const { return m_children.count(); }
+
+   /**
+    * @brief returns whether this item has children still to be materialized (lazy loading mode, see QJsonTreeWidget::setLazyLoadingEnabled())
+    *
+    * @return bool
+    */
+   bool canFetchMore() const { return !m_pendingChildren.isEmpty(); }
+
+   /**
+    * @brief returns the number of children still to be materialized
+    *
+    * @return int
+    */
+   int pendingChildCount() const { return m_pendingChildren.count(); }
+
+   /**
+    * @brief materializes (builds the QJsonTreeItem for) the next count children from the raw "_children_" list kept in lazy loading mode.
+    * note that this doesn't notify the model, use QJsonTreeModel::fetchMore() for items displayed in a view
+    *
+    * @param count number of children to materialize
+    * @return int the number of children materialized
+    */
+   int fetchMore(int count);
+
+   /**
+    * @brief returns the number of childs (recursive) this item has
+    *
+    * @return int
+    */
+   int totalChildCount() const;
+
+   /**
+    * @brief get the total number of items the root item has
+    *
+    * return int
+    */
+   int totalTreeItems() const { return m_root->m_totalTreeItems; }
+
+   /**
+    * @brief returns the number of tree columns this item is represented on (fixed, from JSON root map "_headers_" stored in the root item's columns descriptor)
+    *
+    * @return int
+    */
+   int columnCount() const { return (m_headers ? m_headers->count() : 0); }
+
+   /**
+    * @brief returns columns description (with name,jsontag,idx), keyed by name, jsontag and idx string.
+    * Note that this is rebuilt from the shared headers descriptor at each call, use headerSchema() on hot paths
+    *
+    * @return QHash<QString, QHash<QString, QVariant> >
+    */
+   const QHash<QString, QHash<QString, QVariant> > headers() const { return (m_headers ? m_headers->toHash() : QHash<QString, QHash<QString, QVariant> >()); }
+
+   /**
+    * @brief returns the columns descriptor. this is built once by the root item and shared by all the items of the tree
+    *
+    * @return const QJsonTreeHeaders* 0 if the item is not connected to a tree
+    */
+   const QJsonTreeHeaders* headerSchema() const { return m_headers.constData(); }
+
+   /**
+    * @brief sets the whole internal item map for this item (replace the JSON object)
+    *
+    * @param map the new item map
+    */
+   void setMap (const QVariantMap& map) { m_map = map; updateAttributes(); }
+
+   /**
+    * @brief returns the whole internal map for this item
+    *
+    */
+   const QVariantMap map() const { return m_map; }
+
+   /**
+    * @brief sets a new value in the internal item map
+    *
+    * @param tag the JSON tag name
+    * @param value the new value
+    * @param applyto parameter for the tag (optional)
+    */
+   void setMapValue (const QString& tag, const QVariant& value);
+
+   /**
+    * @brief sets a new value in the internal item map
+    *
+    * @param int the header column index
+    * @param value the new value
+    * @param applyto parameter for the tag (optional)
+    */
+   void setMapValue (int column, const QVariant& value);
+
+   /**
+    * @brief recursively rebuilds the JSON map from the tree structure (to write the tree as JSON, QJsonTreeStreamWriter avoids building the map)
+    *
+    * @return QVariantMap
+    */
+   QVariantMap toMap() const;
+
+   /**
+    * @brief returns the row at which this item is in the tree view, relative to its parent if any.
+    * the row is stored in the item and kept up to date when siblings are inserted/removed, so this is O(1)
+    *
+    * @return int
+    */
+   int row() const { return (m_parent ? m_row : 0); }
+
+   /**
+    * @brief returns the row at which this item is in the tree view, relative to the main root item
+    *
+    * @return int
+    */
+   int rowAbsolute() const;
+
+   /**
+    * @brief returns this item's parent
+    *
+    * @return QJsonTreeItem
+    */
+   QJsonTreeItem* parent() const { return m_parent; }
+
+   /**
+    * @brief returns whether this item has parent or not (if not, this is the root item)
+    *
+    * @return bool
+    */
+   bool hasParent() const { return (m_parent == 0 ? false : true); }
+
+   /**
+    * @brief returns the tree root item
+    *
+    * @return QJsonTreeItem
+    */
+   QJsonTreeItem* rootItem() const { return m_root; }
+
+   /**
+    * @brief returns wether the item has been constructed succesfully or not
+    *
+    * @return bool
+    */
+   bool isValid() const { return (m_error == QJsonTreeItem::JsonNoError); }
+
+   /**
+    * @brief returns an error defined in JsonMapErrors
+    *
+    * @return JsonMapErrors
+    */
+   QJsonTreeItem::JsonMapErrors error() const { return m_error; }
+
+   /**
+    * @brief this is a convenience function which returns the map causing the error.
+    * this will be useful usually only through rootItem()->invalidMap() in case of error during loadJson() from the model
+    *
+    * @return QVariantMap
+    */
+   QVariantMap invalidMap() const { return m_invalidMap; }
+
+   /**
+    * @brief completely clears the item deleting all its child items too. The item can then be reused by calling fromMap()
+    *
+    */
+   void clear();
+
+   /**
+    * @brief returns the QJsonTreeWidget this item belongs to
+    *
+    * @return QJsonTreeWidget
+    */
+   QJsonTreeWidget* widget() const { return m_widget; }
+
+   /**
+    * @brief returns the text at the specified column
+    *
+    * @param idx the column index
+    * @return QString
+    */
+   QString text(int column) const;
+
+   /**
+    * @brief returns true if all the _regexp_ defined in the item's map matches their assigned values, or false if it doesnt.
+    * it's valid only for items representing one or more QLineEdit and having one or more regexps set. if not, it returns true as default
+    *
+    * @param nonmatchingcol on false return, name of the first nonmatching column
+    * @param nonmatchingname on false return, name of the first nonmatching name
+    * @param nonmatchingval on false return, name of the first nonmatching value
+    * @return bool
+    */
+   bool validateRegexp(QString* nonmatchingcol, QString* nonmatchingname, QString* nonmatchingval) const;
+
+   /**
+    * @brief sets the background color for the item (item styles are kept by the QJsonTreeModel of the item widget)
+    *
+    * @param color the color to be set
+    */
+   void setBackgroundColor(const QColor& color);
+
+   /**
+    * @brief returns the background color set for the item, if any
+    *
+    * @return QColor
+    */
+   QColor backgroundColor() const;
+
+   /**
+    * @brief sets the foreground color for the item
+    *
+    * @param color the color to be set
+    */
+   void setForegroundColor (const QColor& color);
+
+   /**
+    * @brief returns the foreground color set for the item, if any
+    *
+    * @return QColor
+    */
+   QColor foregroundColor () const;
+
+   /**
+    * @brief sets the font for the item
+    *
+    * @param font the font to be set
+    */
+   void setFont (const QFont& font);
+
+   /**
+    * @brief returns the font set for the item, if any
+    *
+    * @return QFont
+    */
+   QFont font() const;
+
+   /**
+    * @brief use this instead of hasChildren, for parents with no childrens
+    *
+    * @return bool
+    */
+   bool isTree() const { return (m_attributes & AttrTree); }
+
+   /**
+    * @brief returns whether the whole item is hidden ("_hide_" set)
+    *
+    * @return bool
+    */
+   bool isRowHidden() const { return (m_attributes & AttrRowHidden); }
+
+   /**
+    * @brief returns whether the item is a template item ("_template_" set)
+    *
+    * @return bool
+    */
+   bool isTemplate() const { return (m_attributes & AttrTemplate); }
+
+   /**
+    * @brief returns the value of the first "_readonly_:JSONtag" found in the item, which is checked for special flag ReadOnlyHidesRow
+    *
+    * @return bool
+    */
+   bool hasReadOnlySet() const { return (m_attributes & AttrReadOnlySet); }
+
+   /**
+    * @brief returns whether the value at column is hidden ("_hide_:JSONtag" set)
+    *
+    * @param column the column index
+    * @return bool
+    */
+   bool isColumnHidden(int column) const { return (columnAttributes(column) & ColAttrHidden); }
+
+   /**
+    * @brief returns whether the value at column is readonly ("_readonly_:JSONtag" set to true)
+    *
+    * @param column the column index
+    * @return bool
+    */
+   bool isColumnReadOnly(int column) const { return (columnAttributes(column) & ColAttrReadOnly); }
+
+   /**
+    * @brief returns whether "_readonly_:JSONtag" is present for the value at column, whatever its value
+    *
+    * @param column the column index
+    * @return bool
+    */
+   bool hasColumnReadOnly(int column) const { return (columnAttributes(column) & ColAttrReadOnlyPresent); }
+
+   /**
+    * @brief returns the widget set for the value at column ("_widget_:JSONtag")
+    *
+    * @param column the column index
+    * @return WidgetType
+    */
+   WidgetType widgetType(int column) const { return (WidgetType)(columnAttributes(column) & ColAttrWidgetMask); }
+
+   /**
+    * @brief returns the Qt::ItemFlags to be applied to a value displayed with the given widget
+    *
+    * @param type the widget type
+    * @return Qt::ItemFlags
+    */
+   static Qt::ItemFlags widgetTypeFlags(WidgetType type);
+
+   /**
+    * @brief returns the widget type by its name (i.e. "QLineEdit"), case insensitive
+    *
+    * @param name the widget name
+    * @return WidgetType WidgetNone for an empty name, WidgetUnknown for unsupported widgets
+    */
+   static WidgetType widgetTypeByName(const QString& name);
+
+   /**
+    * @brief returns if the item has an initialized font set
+    *
+    * @return bool
+    */
+   bool isFontValid() const;
+
+   /**
+    * @brief returns the item depth (0 for parents)
+    *
+    * @return int
+    */
+   int depth() const;
+
+ protected:
+   QJsonTreeModel* model();
+   QTreeView *view();
+
+ private:
+   enum Attribute {
+     AttrRowHidden = 1,
+     AttrTemplate = 2,
+     AttrReadOnlySet = 4,
+     AttrTree = 8,
+     AttrStyled = 16, // the item has an entry in the model styles table (not computed from the map)
+     AttrIndexed = 32 // the item is in the model search index (not computed from the map)
+   };
+   enum ColumnAttribute {
+     ColAttrWidgetMask = 7, // WidgetType
+     ColAttrHidden = 8,
+     ColAttrReadOnly = 16,
+     ColAttrReadOnlyPresent = 32
+   };
+   static void buildStaticTables();
+   static void buildWidgetTypes();
+   void updateAttributes();
+   uchar columnAttributes(int column) const { return ((column >= 0 && column < m_columnAttributes.size()) ? (uchar)m_columnAttributes.at(column) : 0); }
+   static void buildDescriptiveTags();
+   bool setColumnHeaders(const QString &headers);
+   void inheritFromParent(QJsonTreeItem* parent);
+   void setItemMap(const QVariantMap& map);
+   void attachSubtree(QJsonTreeItem* parent);
+   void renumberChildren(int from);
+   bool purgeMap(QVariantMap* map) const;
+   QVariantMap rawToMap(const QVariantMap& raw) const;
+   bool lazyLoading() const;
+   void updateSearchIndex();
+   QJsonTreeItemStyle* itemStyle(bool create = false) const;
+   const QString headerNameOrTagByString(const QString &name, bool returntag, int *column) const;
+   const QString headerNameOrTagByInt(int column, bool returntag) const;
+   const QString headerNameByIdx(int column) const;
+   const QString headerNameByTag (const QString& tag, int* column=0) const;
+   const QString headerTagByIdx (int column) const;
+   const QString headerTagByName (const QString& name, int* column=0) const;
+   int headerIdxByTag(const QString &tag) const;
+   int headerIdxByName(const QString &name) const;
+   bool headerIsDrawn(int column) const { return (m_headers && m_headers->isDrawn(column)); }
+   const QJsonTreeItemRender& renderDescriptor(int column) const;
+   static QHash<QString, QJsonTreeItem::WidgetType> widgetTypes;
+   static QStringList descriptiveTags;
+   QJsonTreeItem::JsonMapErrors m_error;
+   QModelIndex m_index;
+   QList<QJsonTreeItem*> m_children;
+   QVariantList m_pendingChildren; // raw "_children_" not yet materialized (lazy loading mode)
+   QVariantMap m_map;
+   QVariantMap m_invalidMap;
+   QJsonTreeItem* m_parent;
+   QJsonTreeItem* m_root;
+   QJsonTreeWidget* m_widget;
+   int m_totalTreeItems;
+   int m_row; // index in the parent m_children
+   uchar m_attributes; // Attribute flags, computed from the map by updateAttributes()
+   QByteArray m_columnAttributes; // ColumnAttribute flags for each column, computed from the map by updateAttributes()
+   QExplicitlySharedDataPointer<QJsonTreeHeaders> m_headers;
+   mutable QVector<QJsonTreeItemRender> m_render; // built on the first paint, cleared when the map changes
+ };
+
+ Q_DECLARE_OPERATORS_FOR_FLAGS(QJsonTreeItem::SpecialFlags)
+
+#endif // QJSONTREEITEM_H
@@ -0,0 +1,122 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qjsontreeitemarena.h"
+
+QJsonTreeItemArena::QJsonTreeItemArena()
+{
+  m_free = 0;
+  m_cur = 0;
+  m_end = 0;
+  m_blockSize = 0;
+  m_live = 0;
+}
+
+QJsonTreeItemArena::~QJsonTreeItemArena()
+{
+  foreach (char* slab, m_slabs)
+  {
+    qFree(slab);
+  }
+}
+
+void* QJsonTreeItemArena::allocate(size_t size, QJsonTreeItemArena *arena)
+{
+  Header* h = 0;
+  if (arena)
+    h = arena->take(size);
+  if (!h)
+  {
+    // heap block
+    h = static_cast<Header*>(qMalloc(sizeof(Header) + size));
+    Q_CHECK_PTR(h);
+    h->arena = 0;
+  }
+  return h + 1;
+}
+
+void QJsonTreeItemArena::release(void *p)
+{
+  if (!p)
+    return;
+
+  Header* h = static_cast<Header*>(p) - 1;
+  QJsonTreeItemArena* arena = h->arena;
+  if (!arena)
+  {
+    qFree(h);
+    return;
+  }
+
+  arena->give(h);
+  if (arena->m_live == 0)
+  {
+    // last block of the document, release the whole arena
+    delete arena;
+  }
+}
+
+QJsonTreeItemArena* QJsonTreeItemArena::arenaOf(const void *p)
+{
+  if (!p)
+    return 0;
+  return (static_cast<const Header*>(p) - 1)->arena;
+}
+
+QJsonTreeItemArena::Header* QJsonTreeItemArena::take(size_t size)
+{
+  // the arena serves a single block size (the first requested), others go to the heap
+  if (m_blockSize == 0)
+    m_blockSize = (sizeof(Header) + size + sizeof(Header) - 1) / sizeof(Header) * sizeof(Header);
+  else if (sizeof(Header) + size > m_blockSize)
+    return 0;
+
+  Header* h;
+  if (m_free)
+  {
+    // reuse a released block
+    h = m_free;
+    m_free = h->next;
+  }
+  else
+  {
+    if (m_cur == m_end)
+    {
+      // current slab exhausted
+      char* slab = static_cast<char*>(qMalloc(m_blockSize * JSON_TREE_ARENA_SLAB_BLOCKS));
+      Q_CHECK_PTR(slab);
+      m_slabs.append(slab);
+      m_cur = slab;
+      m_end = slab + m_blockSize * JSON_TREE_ARENA_SLAB_BLOCKS;
+    }
+    h = reinterpret_cast<Header*>(m_cur);
+    m_cur += m_blockSize;
+  }
+
+  h->arena = this;
+  m_live++;
+  return h;
+}
+
+void QJsonTreeItemArena::give(Header *h)
+{
+  h->next = m_free;
+  m_free = h;
+  m_live--;
+}
@@ -0,0 +1,109 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QJSONTREEITEMARENA_H
+#define QJSONTREEITEMARENA_H
+
+#include <QtCore>
+#include "qjsontree_global.h"
+
+#define JSON_TREE_ARENA_SLAB_BLOCKS 1024 // blocks allocated at once by a QJsonTreeItemArena slab
+
+/**
+ * @brief slab allocator for the QJsonTreeItem nodes of a document.
+ * items are allocated with new (arena) QJsonTreeItem(...), children built by the library use the arena of their parent.
+ * each block is preceded by a small header pointing to its arena, so deleting an item (i.e. by QJsonTreeItem::removeChild()) puts the block back
+ * in the arena free list, and the arena deletes itself, releasing all its slabs at once, when its last block is released.
+ * an arena must be used by one thread at a time (a document is built by a single loader, then handed to the GUI thread).
+ *
+ */
+class QJSONTREE_EXPORT QJsonTreeItemArena
+{
+public:
+  /**
+   * @brief constructor, no memory is allocated until the first block is requested
+   *
+   */
+  QJsonTreeItemArena();
+
+  /**
+   * @brief destructor, frees all the slabs (called when the last block is released)
+   *
+   */
+  ~QJsonTreeItemArena();
+
+  /**
+   * @brief allocates a block from arena, or from the heap if arena is 0 or the requested size isn't the one the arena serves
+   *
+   * @param size the block size
+   * @param arena the arena (optional)
+   * @return void*
+   */
+  static void* allocate(size_t size, QJsonTreeItemArena* arena = 0);
+
+  /**
+   * @brief releases a block obtained by allocate()
+   *
+   * @param p the block
+   */
+  static void release(void* p);
+
+  /**
+   * @brief returns the arena p has been allocated from
+   *
+   * @param p a block obtained by allocate()
+   * @return QJsonTreeItemArena 0 if the block comes from the heap
+   */
+  static QJsonTreeItemArena* arenaOf(const void* p);
+
+  /**
+   * @brief returns the number of blocks currently allocated from the arena
+   *
+   * @return int
+   */
+  int liveBlocks() const { return m_live; }
+
+  /**
+   * @brief returns the number of slabs allocated by the arena
+   *
+   * @return int
+   */
+  int slabCount() const { return m_slabs.count(); }
+
+private:
+  union Header {
+    QJsonTreeItemArena* arena;
+    Header* next; // free list link, when the block is free
+    double align1;
+    qint64 align2;
+  };
+
+  Header* take(size_t size);
+  void give(Header* h);
+
+  QList<char*> m_slabs;
+  Header* m_free;
+  char* m_cur;
+  char* m_end;
+  size_t m_blockSize;
+  int m_live;
+  Q_DISABLE_COPY(QJsonTreeItemArena)
+};
+
+#endif // QJSONTREEITEMARENA_H
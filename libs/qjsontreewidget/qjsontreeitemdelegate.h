@@ -1,124 +1,152 @@
-/*
-    This file is part of QJsonTreeWidget.
-
-    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
-
-    QJsonTreeWidget is free software: you can redistribute it and/or modify
-    it under the terms of the GNU General Public License as published by
-    the Free Software Foundation, either version 3 of the License, or
-    (at your option) any later version.
-
-    QJsonTreeWidget is distributed in the hope that it will be useful,
-    but WITHOUT ANY WARRANTY; without even the implied warranty of
-    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-    GNU General Public License for more details.
-
-    You should have received a copy of the GNU General Public License
-    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
- */
-
-#ifndef QJSONTREEITEMDELEGATE_H
-#define QJSONTREEITEMDELEGATE_H
-
-#include <QtCore>
-#include <QtGui>
-#include "qjsontreemodel.h"
-#include "qjsonsortfilterproxymodel.h"
-
-class QJsonTreeWidget;
-
-/**
- * @brief class to display/edit data using the QJsonTreeModel model class
- *
- */
-class QJsonTreeItemDelegate : public QStyledItemDelegate
-{
-  friend class QJsonTreeModel;
-  friend class QJsonTreeItem;
-
-  Q_OBJECT
-public:  
-  /**
-   * @brief constructor
-   *
-   * @param proxy the proxy model used for sorting/filtering
-   */
-  explicit QJsonTreeItemDelegate(QObject *parent = 0);
-
-  /**
-   * @brief destructor
-   *
-   */
-  virtual ~QJsonTreeItemDelegate();
-
-   /**
-     * @brief reimplementation of createEditor() from QAbstractItemDelegate interface
-     *
-     * @param parent the parent widget
-     * @param option parameters to draw the widget
-     * @param index the model index
-     */
-    virtual QWidget* createEditor ( QWidget * parent, const QStyleOptionViewItem & option, const QModelIndex & index ) const;
-
-    /**
-     * @brief reimplementation of setEditorData() from QAbstractItemDelegate interface
-     *
-     * @param editor the editor
-     * @param index the model index
-     */
-    virtual void	setEditorData ( QWidget * editor, const QModelIndex & index ) const;
-
-    /**
-     * @brief reimplementation of setModelData() from QAbstractItemDelegate interface
-     *
-     * @param editor the editor
-     * @param model the model
-     * @param index the model index
-     */
-    virtual void	setModelData ( QWidget * editor, QAbstractItemModel * model, const QModelIndex & index ) const;
-
-    /**
-     * @brief reimplementation of paint() from QAbstractItemDelegate interface
-     *
-     * @param painter the painter to render the item
-     * @param option the options to render the item
-     * @param index the model index
-     */
-    virtual void paint ( QPainter * painter, const QStyleOptionViewItem & option, const QModelIndex & index ) const;
-
-    /**
-     * @brief reimplementation of updateEditorGeometry() from QAbstractItemDelegate interface
-     *
-     * @param editor the editor
-     * @param option the options to render the item
-     * @param index the model index
-     */
-    virtual void	updateEditorGeometry ( QWidget * editor, const QStyleOptionViewItem & option, const QModelIndex & index ) const;
-
-    /**
-     * @brief reimplementation of editorEvent() from QAbstractItemDelegate interface
-     *
-     * @param event the event (mouse events, ...)
-     * @param model the model
-     * @param option the options to render the item
-     * @param index the model index
-     */
-    virtual bool editorEvent ( QEvent * event, QAbstractItemModel * model, const QStyleOptionViewItem & option, const QModelIndex & index );
-
-signals:
-    void clicked (int column, int row, const QString& jsontag, const QVariant& value, const QJsonTreeItem* item);
-    void clicked (const QJsonTreeItem* item, const QString& jsontag);
-
-private:
-    QList<QJsonTreeItem *> templatesByItem(QJsonTreeItem *item) const;
-    QJsonTreeItem* templateByName(QJsonTreeItem *item, const QString &name) const;
-    int countParentChildsByName(QJsonTreeItem *item, const QString &name) const;
-    void handleLeftMousePress(const QModelIndex &index);
-    void handleRightMousePress(QMouseEvent *event, const QModelIndex &index);
-    void drawButton(const QStyleOptionViewItem &option, QPainter *painter, const QStyle::ControlElement type, const QString &text=QString(), const QString& pixmap=QString(), bool checked=false) const;
-    QHash<QString,QStyle::ControlElement> m_widgetTypes;
-    void buildWidgetTypes();
-    void execMenu(const QModelIndex &index, QJsonTreeItem *item, QMenu *menu, const QPoint &pos) const;
-};
-
-#endif // QJSONTREEITEMDELEGATE_H
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QJSONTREEITEMDELEGATE_H
+#define QJSONTREEITEMDELEGATE_H
+
+#include <QtCore>
+#include <QtGui>
+#include "qjsontreemodel.h"
+#include "qjsonsortfilterproxymodel.h"
+#include "qjsontreevaluedomain.h"
+
+class QJsonTreeWidget;
+
+#define JSON_TREE_EDITOR_CACHE_SIZE 64 // compiled regexps kept by createEditor()
+#define JSON_TREE_VALUE_DOMAINS_MAX_VALUES 262144 // values kept by the "_valuelist_" domains registry
+
+/**
+ * @brief class to display/edit data using the QJsonTreeModel model class
+ *
+ */
+class QJsonTreeItemDelegate : public QStyledItemDelegate
+{
+  friend class QJsonTreeModel;
+  friend class QJsonTreeItem;
+
+  Q_OBJECT
+public:  
+  /**
+   * @brief constructor
+   *
+   * @param proxy the proxy model used for sorting/filtering
+   */
+  explicit QJsonTreeItemDelegate(QObject *parent = 0);
+
+  /**
+   * @brief destructor
+   *
+   */
+  virtual ~QJsonTreeItemDelegate();
+
+  /**
+   * @brief drops the value domains and regexps cached by createEditor(). the editors currently open keep validating: combo boxes hold a
+   * reference to their domain, line edits own their validator
+   *
+   */
+  void clearEditorCache();
+
+  /**
+   * @brief invalidates the controls rendered by paint(), to be called on style or palette changes (QJsonTreeWidget does)
+   *
+   */
+  static void styleChanged();
+
+  /**
+   * @brief returns the shared domain for a "_valuelist_" string, parsing it on the first request. domains are kept up to
+   * JSON_TREE_VALUE_DOMAINS_MAX_VALUES values overall, the least recently used are dropped first
+   *
+   * @param list the "_valuelist_" string
+   * @return QSharedPointer<QJsonTreeValueDomain> null if list is empty. holding it keeps the domain alive after it's dropped from the registry
+   */
+  QSharedPointer<QJsonTreeValueDomain> valueDomain(const QString& list) const;
+
+   /**
+     * @brief reimplementation of createEditor() from QAbstractItemDelegate interface
+     *
+     * @param parent the parent widget
+     * @param option parameters to draw the widget
+     * @param index the model index
+     */
+    virtual QWidget* createEditor ( QWidget * parent, const QStyleOptionViewItem & option, const QModelIndex & index ) const;
+
+    /**
+     * @brief reimplementation of setEditorData() from QAbstractItemDelegate interface
+     *
+     * @param editor the editor
+     * @param index the model index
+     */
+    virtual void	setEditorData ( QWidget * editor, const QModelIndex & index ) const;
+
+    /**
+     * @brief reimplementation of setModelData() from QAbstractItemDelegate interface
+     *
+     * @param editor the editor
+     * @param model the model
+     * @param index the model index
+     */
+    virtual void	setModelData ( QWidget * editor, QAbstractItemModel * model, const QModelIndex & index ) const;
+
+    /**
+     * @brief reimplementation of paint() from QAbstractItemDelegate interface
+     *
+     * @param painter the painter to render the item
+     * @param option the options to render the item
+     * @param index the model index
+     */
+    virtual void paint ( QPainter * painter, const QStyleOptionViewItem & option, const QModelIndex & index ) const;
+
+    /**
+     * @brief reimplementation of updateEditorGeometry() from QAbstractItemDelegate interface
+     *
+     * @param editor the editor
+     * @param option the options to render the item
+     * @param index the model index
+     */
+    virtual void	updateEditorGeometry ( QWidget * editor, const QStyleOptionViewItem & option, const QModelIndex & index ) const;
+
+    /**
+     * @brief reimplementation of editorEvent() from QAbstractItemDelegate interface
+     *
+     * @param event the event (mouse events, ...)
+     * @param model the model
+     * @param option the options to render the item
+     * @param index the model index
+     */
+    virtual bool editorEvent ( QEvent * event, QAbstractItemModel * model, const QStyleOptionViewItem & option, const QModelIndex & index );
+
+signals:
+    void clicked (int column, int row, const QString& jsontag, const QVariant& value, const QJsonTreeItem* item);
+    void clicked (const QJsonTreeItem* item, const QString& jsontag);
+
+private:
+    QList<QJsonTreeItem *> templatesByItem(QJsonTreeItem *item) const;
+    QJsonTreeItem* templateByName(QJsonTreeItem *item, const QString &name) const;
+    int countParentChildsByName(QJsonTreeItem *item, const QString &name) const;
+    void handleLeftMousePress(const QModelIndex &index);
+    QSharedPointer<QJsonTreeValueDomain> editorDomain(const QWidget* editor) const;
+    void handleRightMousePress(QMouseEvent *event, const QModelIndex &index);
+    void drawButton(const QStyleOptionViewItem &option, QPainter *painter, const QStyle::ControlElement type, const QString &text=QString(), const QString& pixmap=QString(), bool checked=false) const;
+    mutable QHash<QString,QIcon> m_icons; // drawButton() icons by pixmap path
+    mutable QCache<QString,QSharedPointer<QJsonTreeValueDomain> > m_valueDomains; // "_valuelist_" parsed, by the raw string. open combo boxes hold a reference too
+    mutable QCache<QString,QRegExp> m_regexps; // "_regexp_" compiled, by pattern. each line edit validator holds a copy
+    void execMenu(const QModelIndex &index, QJsonTreeItem *item, QMenu *menu, const QPoint &pos) const;
+};
+
+#endif // QJSONTREEITEMDELEGATE_H
@@ -0,0 +1,83 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qjsontreeloader.h"
+#include "qjsontreewidget.h"
+
+/**
+ * @brief stream reader reporting to the loader, and stopping when the load is canceled
+ *
+ */
+class QJsonTreeLoaderReader : public QJsonTreeStreamReader
+{
+public:
+  QJsonTreeLoaderReader(QJsonTreeWidget* tree, QJsonTreeLoader* loader) : QJsonTreeStreamReader(tree) { m_loader = loader; }
+
+protected:
+  virtual bool chunkRead(qint64 bytesRead, int items)
+  {
+    if (m_loader->isCanceled())
+      return false;
+    m_loader->reportProgress(bytesRead,items);
+    return true;
+  }
+
+private:
+  QJsonTreeLoader* m_loader;
+};
+
+QJsonTreeLoader::QJsonTreeLoader(QJsonTreeWidget *tree, const QString &path, QObject *parent) :
+  QThread(parent)
+{
+  m_tree = tree;
+  m_path = path;
+  m_root = 0;
+  m_bytesTotal = 0;
+}
+
+QJsonTreeLoader::~QJsonTreeLoader()
+{
+  // must not be deleted while running
+  cancel();
+  wait();
+  delete m_root;
+}
+
+void QJsonTreeLoader::run()
+{
+  QFile file(m_path);
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    m_error = tr("loadJsonAsync: can't open %1: %2").arg(m_path).arg(file.errorString());
+    return;
+  }
+  m_bytesTotal = file.size();
+
+  QJsonTreeLoaderReader reader(m_tree,this);
+  m_root = m_tree->buildTreeFromStream(reader,file,&m_error);
+  file.close();
+
+  if (isCanceled())
+  {
+    // the tree (if any) is discarded
+    delete m_root;
+    m_root = 0;
+    m_error = tr("loadJsonAsync: loading canceled");
+  }
+}
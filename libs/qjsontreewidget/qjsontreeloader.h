@@ -0,0 +1,108 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QJSONTREELOADER_H
+#define QJSONTREELOADER_H
+
+#include <QtCore>
+#include "qjsontreeitem.h"
+
+class QJsonTreeWidget;
+
+/**
+ * @brief worker thread used by QJsonTreeWidget::loadJsonAsync(), it reads and parses the JSON file and builds the whole items tree off the GUI thread
+ *
+ */
+class QJsonTreeLoader : public QThread
+{
+  Q_OBJECT
+public:
+  /**
+   * @brief constructor
+   *
+   * @param tree the QJsonTreeWidget the built items will belong to
+   * @param path path to the JSON file
+   * @param parent the parent object (optional)
+   */
+  QJsonTreeLoader(QJsonTreeWidget* tree, const QString& path, QObject* parent = 0);
+
+  /**
+   * @brief destructor, deletes the built tree if it has not been taken
+   *
+   */
+  virtual ~QJsonTreeLoader();
+
+  /**
+   * @brief requests cancellation, the thread stops at the next chunk read. safe to call from any thread
+   *
+   */
+  void cancel() { m_canceled.fetchAndStoreOrdered(1); }
+
+  /**
+   * @brief returns whether cancel() has been called
+   *
+   * @return bool
+   */
+  bool isCanceled() const { return (m_canceled.fetchAndAddOrdered(0) != 0); }
+
+  /**
+   * @brief returns the built invisible root item once the thread has finished (0 on error), ownership passes to the caller
+   *
+   * @return QJsonTreeItem
+   */
+  QJsonTreeItem* takeRoot() { QJsonTreeItem* r = m_root; m_root = 0; return r; }
+
+  /**
+   * @brief returns the detailed error once the thread has finished, if takeRoot() returns 0
+   *
+   * @return const QString
+   */
+  const QString error() const { return m_error; }
+
+  /**
+   * @brief emits progress(), used by the stream reader running in this thread
+   *
+   * @param bytesRead bytes read so far
+   * @param items items built so far
+   */
+  void reportProgress(qint64 bytesRead, int items) { emit progress(bytesRead,m_bytesTotal,items); }
+
+signals:
+  /**
+   * @brief emitted (from the worker thread) each time a chunk of the file has been parsed
+   *
+   * @param bytesRead bytes read so far
+   * @param bytesTotal the file size
+   * @param items items built so far
+   */
+  void progress(qint64 bytesRead, qint64 bytesTotal, int items);
+
+protected:
+  virtual void run();
+
+private:
+  QJsonTreeWidget* m_tree;
+  QString m_path;
+  QJsonTreeItem* m_root;
+  QString m_error;
+  qint64 m_bytesTotal;
+  mutable QAtomicInt m_canceled;
+};
+
+#endif // QJSONTREELOADER_H
@@ -1,414 +1,804 @@
-/*
-    This file is part of QJsonTreeWidget.
-
-    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
-
-    QJsonTreeWidget is free software: you can redistribute it and/or modify
-    it under the terms of the GNU General Public License as published by
-    the Free Software Foundation, either version 3 of the License, or
-    (at your option) any later version.
-
-    QJsonTreeWidget is distributed in the hope that it will be useful,
-    but WITHOUT ANY WARRANTY; without even the implied warranty of
-    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-    GNU General Public License for more details.
-
-    You should have received a copy of the GNU General Public License
-    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
- */
-
-#include "qjsontreemodel.h"
-
-QJsonTreeModel::QJsonTreeModel(QObject *parent, QJsonTreeItem* root) :
-  QAbstractItemModel(parent)
-{
-  m_specialFlags = QJsonTreeItem::HonorAll;
-  m_childsFont = QFont();
-  m_childsFontValid = false;
-  m_childsForeColor = QColor();
-  m_childsBackColor = QColor();
-  m_parentsFont = QFont();
-  m_parentsFontValid = false;
-  m_parentsForeColor = QColor();
-  m_parentsBackColor = QColor();
-
-  m_root = root;
-}
-
-QJsonTreeModel::~QJsonTreeModel()
-{
-  this->clear();
-}
-
-
-QJsonTreeItem *QJsonTreeModel::parentItem(const QModelIndex &parent) const
-{
-  if (!parent.isValid())
-  {
-    // invalid, use root item
-    return m_root;
-  }
-  // get from index
-  return static_cast<QJsonTreeItem*>(parent.internalPointer());
-}
-
-QModelIndex QJsonTreeModel::index(int row, int column, const QModelIndex &parent) const
-{
-  // if we haven't an index, just return an empty index
-  if (!hasIndex(row, column, parent))
-    return QModelIndex();
-
-  // get the parent item
-  QJsonTreeItem* parentit = parentItem(parent);
-  if (parentit == 0)
-    return QModelIndex();
-
-  // since we're referring to a child item of the parent, if it exists create an index for it
-  QJsonTreeItem* child = parentit->child(row);
-  if (!child)
-    return QModelIndex();
-
-  // check various item options
-  QVariantMap m = child->map();
-  QString tag = child->headerTagByIdx(column);  
-  bool b = m.value("__hasROSet__",false).toBool();
-  if (b && (m_specialFlags & QJsonTreeItem::ReadOnlyHidesRow) && (m_specialFlags & QJsonTreeItem::HonorHide))
-  {
-    // hides the whole row
-      return QModelIndex();
-  }
-
-  b = m.value("_template_",false).toBool();
-  if (b)
-  {
-    // always hide templates
-    return QModelIndex();
-  }
-
-  b = m.value("_hide_",false).toBool();
-  if (b && (m_specialFlags & QJsonTreeItem::HonorHide))
-  {
-    // hide the whole row
-    return QModelIndex();
-  }
-  b = m.value("_hide_:" % tag,false).toBool();
-  if (b && (m_specialFlags & QJsonTreeItem::HonorHide))
-  {
-    // hide only this value
-    return QModelIndex();
-  }
-  return createIndex (row, column, child);
-}
-
-QModelIndex QJsonTreeModel::parent(const QModelIndex &index) const
-{
-  if (!index.isValid())
-    return QModelIndex();
-
-  // look for child parent
-  QJsonTreeItem* child = static_cast<QJsonTreeItem*>(index.internalPointer());
-   if (child == 0)
-     return QModelIndex();
-
-   QJsonTreeItem* parent = child->parent();
-
-   if (parent == m_root)
-     return QModelIndex();
-
-   return createIndex (parent->row(), 0, parent);
-}
-
-int QJsonTreeModel::columnCount(const QModelIndex &parent) const
-{
-  Q_UNUSED(parent);
-  if (m_root)
-  {
-    // return root item's column count (from the _columns_ descriptor)
-    return m_root->columnCount();
-  }
-  return 0;
-}
-
-QVariant QJsonTreeModel::data(const QModelIndex &index, int role) const
-{
-  QJsonTreeItem* item;
-  QString tag = tagByModelIndex(index,&item,role);
-  if (tag.isEmpty())
-    return QVariant();
-
-  // check roles
-  switch (role)
-  {
-    case Qt::ForegroundRole:
-      // read only should be always displayed as disabled
-      if (item->map().contains("_readonly_:" % tag))
-        return QVariant();
-
-      // item color has precedence
-      if (item->foregroundColor().isValid() && (m_specialFlags & QJsonTreeItem::HonorItemForegroundColor))
-        return QVariant(item->foregroundColor());
-
-      // check parent/child color then
-      if (item->isTree() || item->hasChildren())
-      {
-        if (m_parentsForeColor.isValid() && (m_specialFlags & QJsonTreeItem::HonorParentsForegroundColor))
-          return QVariant(m_parentsForeColor);
-      }
-      else
-      {
-        if (m_childsForeColor.isValid() && (m_specialFlags & QJsonTreeItem::HonorChildsForegroundColor))
-          return QVariant(m_childsForeColor);
-      }
-
-      // then the column color
-      if (columnForegroundColor(tag).isValid()  && (m_specialFlags & QJsonTreeItem::HonorColumnForegroundColor))
-        return QVariant(columnForegroundColor(tag));
-      return QVariant();
-    break;
-
-    case Qt::BackgroundRole:
-      // item color has precedence
-      if (item->backgroundColor().isValid() && (m_specialFlags & QJsonTreeItem::HonorItemBackgroundColor))
-        return QVariant(item->backgroundColor());
-
-      // check parent/child color then
-      if (item->isTree() || item->hasChildren())
-      {
-        if (m_parentsBackColor.isValid() && (m_specialFlags & QJsonTreeItem::HonorParentsBackgroundColor))
-          return QVariant(m_parentsBackColor);
-      }
-      else
-      {
-        if (m_childsBackColor.isValid() && (m_specialFlags & QJsonTreeItem::HonorChildsBackgroundColor))
-          return QVariant(m_childsBackColor);
-      }
-
-      // then the column color
-      if (columnBackgroundColor(tag).isValid() && (m_specialFlags & QJsonTreeItem::HonorColumnBackgroundColor))
-        return QVariant(columnBackgroundColor(tag));
-      return QVariant();
-    break;
-
-    case Qt::FontRole:
-      // item font has precedence
-      if (item->isFontValid() && (m_specialFlags & QJsonTreeItem::HonorItemFont))
-        return QVariant(item->font());
-
-      // check parent/child font then
-      if (item->isTree() || item->hasChildren())
-      {
-        if (m_parentsFontValid && (m_specialFlags & QJsonTreeItem::HonorParentsFont))
-          return QVariant(m_parentsFont);
-      }
-      else
-      {
-        if (m_childsFontValid && (m_specialFlags & QJsonTreeItem::HonorChildsFont))
-          return QVariant(m_childsFont);
-      }
-
-      // then the column font
-      if (!(m_specialFlags & QJsonTreeItem::HonorColumnFont))
-        return QVariant();
-      if (m_columnFonts.value(tag % ":valid",false).toBool())
-        return QVariant(columnFont(tag));
-      return QVariant();
-    break;
-
-    default:
-      break;
-  }
-
-  // skip custom drawn items (they could be buttons, they have usually no values... maybe we could change that later)
-  QHash<QString, QHash<QString, QVariant> >  h = item->headers();
-  if (h[tag].contains("__draw__"))
-    return QVariant();
-
-  // get the value that has been set in json
-  return item->map().value(tag,QVariant());
-}
-
-bool QJsonTreeModel::setData(const QModelIndex &index, const QVariant &value, int role)
-{
-  QJsonTreeItem* item = itemByModelIndex(index,role);
-  if (!item)
-    return false;
-  if (value.canConvert(QVariant::Map))
-  {
-    // replace the whole map
-    item->fromMap(value.toMap(),item->parent());
-  }
-  else
-  {
-    // replace data at the specified JSON tag
-    item->setMapValue(index.column(),value);
-  }
-  emit dataChanged(index,index);
-
-  return true;
-}
-
-Qt::ItemFlags QJsonTreeModel::flags(const QModelIndex &index) const
-{
-  // default
-  Qt::ItemFlags f = QAbstractItemModel::flags(index);
-
-  // get tag for this index
-  QJsonTreeItem* item;
-  QString tag = tagByModelIndex(index,&item);
-  if (tag.isEmpty())
-    return f;
-
-  // if it's readonly, remove the enabled flag
-  bool b = item->map().value("_readonly_:" % tag,false).toBool();
-  if (b && (m_specialFlags & QJsonTreeItem::HonorReadOnly))
-  {
-    f &= ~Qt::ItemIsEnabled;
-  }
-
-  // if it's a widget, get flags to apply from the Qt::ItemFlags stored in our hash
-  QString w = item->map().value("_widget_:" % tag,QString()).toString();
-  if (!w.isEmpty())
-  {
-    f |= (QJsonTreeItem::widgetFlags[w]);
-  }
-  return f;
-}
-
-QVariant QJsonTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
-{
-  Q_UNUSED(orientation);
-  if (!m_root)
-    return QVariant();
-
-  if (role == Qt::DisplayRole)
-    return m_root->headerNameByIdx(section);
-  return QVariant();
-}
-
-bool QJsonTreeModel::removeRows(int row, int count, const QModelIndex &parent)
-{
-  QJsonTreeItem* parentit = itemByModelIndex(parent);
-  if (!parentit || count == 0)
-    return false;
-
-  // this will remove rows starting from the specified row
-  beginRemoveRows(parent,row,row+count-1);
-  for (int i=row; i < (row+count); i++)
-  {
-    // this deletes the child too
-    parentit->removeChild(i);
-  }
-  endRemoveRows();
-  return true;
-}
-
-bool QJsonTreeModel::insertRows(int row, int count, const QModelIndex &parent)
-{
-  QJsonTreeItem* parentit = itemByModelIndex(parent);
-  if (!parentit || count == 0)
-    return false;
-
-  beginInsertRows(parent,row,row+count-1);
-  for (int i = 0; i < count; i++)
-  {
-    QJsonTreeItem* newitem = new QJsonTreeItem(parentit->widget(),parentit);
-    parentit->appendChild(newitem);
-  }
-  endInsertRows();
-
-  return true;
-}
-
-bool QJsonTreeModel::insertRow(int row, const QModelIndex &parent)
-{
-  return insertRows(row,1,parent);
-}
-
-bool QJsonTreeModel::hasChildren(const QModelIndex &parent)
-{
-  QJsonTreeItem* item = itemByModelIndex(parent);
-  if (item && item->childCount() > 0)
-    return true;
-  return false;
-}
-
-int QJsonTreeModel::rowCount(const QModelIndex &parent) const
-{
-  // since it's a tree, consider column 0 only
-  if (parent.column() > 0)
-    return 0;
-
-  QJsonTreeItem* item = parentItem(parent);
-  if (item == 0)
-    return 0;
-
-  // simply return item children count (= rows under that item)
-  return item->childCount();
-}
-
-void QJsonTreeModel::clear()
-{
-  beginResetModel();
-  if (m_root)
-  {
-    delete m_root;
-    m_root = 0;
-  }
-  endResetModel();
-}
-
-void QJsonTreeModel::setSpecialFlags(QJsonTreeItem::SpecialFlags flags)
-{
-  // special flags is updated, so we need to change the layout and inform the view
-  emit layoutAboutToBeChanged();
-  m_specialFlags = flags;
-  emit layoutChanged();
-}
-
-QJsonTreeItem *QJsonTreeModel::itemByModelIndex(const QModelIndex &index, int role) const
-{
-  // check if index is valid and one of these roles is requested
-  QList <int> roles;
-  roles << Qt::DisplayRole << Qt::EditRole << Qt::FontRole << Qt::BackgroundRole << Qt::ForegroundRole << Qt::ToolTipRole;
-  if (!index.isValid() || !roles.contains(role))
-    return 0;
-
-  // get item
-  return static_cast<QJsonTreeItem*>(index.internalPointer());
-}
-
-QVariantMap QJsonTreeModel::mapByModelIndex(const QModelIndex &index, QJsonTreeItem** item, int role) const
-{
-  QJsonTreeItem* it = itemByModelIndex(index,role);
-  if (!it)
-    return QVariantMap();
-
-  if (item)
-    *item = it;
-
-  // get item map
-  return it->map();
-}
-
-const QString QJsonTreeModel::tagByModelIndex (const QModelIndex &index, QJsonTreeItem** item, int role) const
-{
-  // get item data
-  QJsonTreeItem* it;
-  QVariantMap m = mapByModelIndex(index,&it,role);
-  if (m.isEmpty())
-    return QString();
-  if (item)
-    *item = it;
-  return it->headerTagByIdx(index.column());
-}
-
-const QModelIndex QJsonTreeModel::indexByItem(QJsonTreeItem* item, int column) const
-{
-  if (item == m_root)
-    return QModelIndex();
-  QJsonTreeItem* par = item->parent();
-  if (!par)
-    par = m_root;
-  int row = par->children().lastIndexOf(item);
-  return createIndex (row,column,item);
-}
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qjsontreemodel.h"
+
+QJsonTreeModel::QJsonTreeModel(QObject *parent, QJsonTreeItem* root) :
+  QAbstractItemModel(parent)
+{
+  m_specialFlags = QJsonTreeItem::HonorAll;
+  m_childsFont = QFont();
+  m_childsFontValid = false;
+  m_childsForeColor = QColor();
+  m_childsBackColor = QColor();
+  m_parentsFont = QFont();
+  m_parentsFontValid = false;
+  m_parentsForeColor = QColor();
+  m_parentsBackColor = QColor();
+
+  m_root = root;
+  m_searchIndex = 0;
+  m_batchDepth = 0;
+}
+
+QJsonTreeModel::~QJsonTreeModel()
+{
+  this->clear();
+  delete m_searchIndex;
+}
+
+
+void QJsonTreeModel::setRoot(QJsonTreeItem *root)
+{
+  // the view never sees an empty model in between
+  beginResetModel();
+  m_batchChanges.clear();
+  if (m_searchIndex)
+    m_searchIndex->clear();
+  delete m_root;
+  m_root = root;
+  if (m_searchIndex && m_root)
+    m_searchIndex->addSubtree(m_root);
+  endResetModel();
+}
+
+void QJsonTreeModel::setSearchIndexEnabled(bool enable)
+{
+  if (!enable)
+  {
+    if (m_searchIndex)
+      m_searchIndex->clear();
+    delete m_searchIndex;
+    m_searchIndex = 0;
+    return;
+  }
+
+  if (m_searchIndex)
+    return;
+  m_searchIndex = new QJsonTreeSearchIndex();
+  if (m_root)
+    m_searchIndex->addSubtree(m_root);
+}
+
+void QJsonTreeModel::indexChildren(QJsonTreeItem *item, int from, int count)
+{
+  if (!m_searchIndex)
+    return;
+  int to = (count < 0 ? item->childCount() : qMin(from + count,item->childCount()));
+  for (int i=from; i < to; i++)
+  {
+    m_searchIndex->addItem(item->child(i));
+  }
+}
+
+QJsonTreeItemStyle* QJsonTreeModel::itemStyle(const QJsonTreeItem *item, bool create)
+{
+  QHash<const QJsonTreeItem*, QJsonTreeItemStyle>::iterator it = m_itemStyles.find(item);
+  if (it == m_itemStyles.end())
+  {
+    if (!create)
+      return 0;
+    it = m_itemStyles.insert(item,QJsonTreeItemStyle());
+  }
+  return &it.value();
+}
+
+QJsonTreeItem *QJsonTreeModel::parentItem(const QModelIndex &parent) const
+{
+  if (!parent.isValid())
+  {
+    // invalid, use root item
+    return m_root;
+  }
+  // get from index
+  return static_cast<QJsonTreeItem*>(parent.internalPointer());
+}
+
+QModelIndex QJsonTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+  // if we haven't an index, just return an empty index
+  if (!hasIndex(row, column, parent))
+    return QModelIndex();
+
+  // get the parent item
+  QJsonTreeItem* parentit = parentItem(parent);
+  if (parentit == 0)
+    return QModelIndex();
+
+  // since we're referring to a child item of the parent, if it exists create an index for it
+  QJsonTreeItem* child = parentit->child(row);
+  if (!child)
+    return QModelIndex();
+
+  // check various item options (precomputed in the item attributes)
+  if (child->hasReadOnlySet() && (m_specialFlags & QJsonTreeItem::ReadOnlyHidesRow) && (m_specialFlags & QJsonTreeItem::HonorHide))
+  {
+    // hides the whole row
+      return QModelIndex();
+  }
+
+  if (child->isTemplate())
+  {
+    // always hide templates
+    return QModelIndex();
+  }
+
+  if (child->isRowHidden() && (m_specialFlags & QJsonTreeItem::HonorHide))
+  {
+    // hide the whole row
+    return QModelIndex();
+  }
+  if (child->isColumnHidden(column) && (m_specialFlags & QJsonTreeItem::HonorHide))
+  {
+    // hide only this value
+    return QModelIndex();
+  }
+  return createIndex (row, column, child);
+}
+
+QModelIndex QJsonTreeModel::parent(const QModelIndex &index) const
+{
+  if (!index.isValid())
+    return QModelIndex();
+
+  // look for child parent
+  QJsonTreeItem* child = static_cast<QJsonTreeItem*>(index.internalPointer());
+   if (child == 0)
+     return QModelIndex();
+
+   QJsonTreeItem* parent = child->parent();
+
+   if (parent == m_root)
+     return QModelIndex();
+
+   return createIndex (parent->row(), 0, parent);
+}
+
+int QJsonTreeModel::columnCount(const QModelIndex &parent) const
+{
+  Q_UNUSED(parent);
+  if (m_root)
+  {
+    // return root item's column count (from the _columns_ descriptor)
+    return m_root->columnCount();
+  }
+  return 0;
+}
+
+QVariant QJsonTreeModel::data(const QModelIndex &index, int role) const
+{
+  QJsonTreeItem* item;
+  QString tag = tagByModelIndex(index,&item,role);
+  if (tag.isEmpty())
+    return QVariant();
+
+  // check roles
+  switch (role)
+  {
+    case Qt::ForegroundRole:
+      // read only should be always displayed as disabled
+      if (item->hasColumnReadOnly(index.column()))
+        return QVariant();
+
+      // item color has precedence
+      if (item->foregroundColor().isValid() && (m_specialFlags & QJsonTreeItem::HonorItemForegroundColor))
+        return QVariant(item->foregroundColor());
+
+      // check parent/child color then
+      if (item->isTree() || item->hasChildren())
+      {
+        if (m_parentsForeColor.isValid() && (m_specialFlags & QJsonTreeItem::HonorParentsForegroundColor))
+          return QVariant(m_parentsForeColor);
+      }
+      else
+      {
+        if (m_childsForeColor.isValid() && (m_specialFlags & QJsonTreeItem::HonorChildsForegroundColor))
+          return QVariant(m_childsForeColor);
+      }
+
+      // then the column color
+      if (columnForegroundColor(tag).isValid()  && (m_specialFlags & QJsonTreeItem::HonorColumnForegroundColor))
+        return QVariant(columnForegroundColor(tag));
+      return QVariant();
+    break;
+
+    case Qt::BackgroundRole:
+      // item color has precedence
+      if (item->backgroundColor().isValid() && (m_specialFlags & QJsonTreeItem::HonorItemBackgroundColor))
+        return QVariant(item->backgroundColor());
+
+      // check parent/child color then
+      if (item->isTree() || item->hasChildren())
+      {
+        if (m_parentsBackColor.isValid() && (m_specialFlags & QJsonTreeItem::HonorParentsBackgroundColor))
+          return QVariant(m_parentsBackColor);
+      }
+      else
+      {
+        if (m_childsBackColor.isValid() && (m_specialFlags & QJsonTreeItem::HonorChildsBackgroundColor))
+          return QVariant(m_childsBackColor);
+      }
+
+      // then the column color
+      if (columnBackgroundColor(tag).isValid() && (m_specialFlags & QJsonTreeItem::HonorColumnBackgroundColor))
+        return QVariant(columnBackgroundColor(tag));
+      return QVariant();
+    break;
+
+    case Qt::FontRole:
+      // item font has precedence
+      if (item->isFontValid() && (m_specialFlags & QJsonTreeItem::HonorItemFont))
+        return QVariant(item->font());
+
+      // check parent/child font then
+      if (item->isTree() || item->hasChildren())
+      {
+        if (m_parentsFontValid && (m_specialFlags & QJsonTreeItem::HonorParentsFont))
+          return QVariant(m_parentsFont);
+      }
+      else
+      {
+        if (m_childsFontValid && (m_specialFlags & QJsonTreeItem::HonorChildsFont))
+          return QVariant(m_childsFont);
+      }
+
+      // then the column font
+      if (!(m_specialFlags & QJsonTreeItem::HonorColumnFont))
+        return QVariant();
+      if (m_columnFonts.value(tag % ":valid",false).toBool())
+        return QVariant(columnFont(tag));
+      return QVariant();
+    break;
+
+    default:
+      break;
+  }
+
+  // skip custom drawn items (they could be buttons, they have usually no values... maybe we could change that later)
+  if (item->headerIsDrawn(index.column()))
+    return QVariant();
+
+  // get the value that has been set in json
+  return item->m_map.value(tag,QVariant());
+}
+
+bool QJsonTreeModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+  QJsonTreeItem* item = itemByModelIndex(index,role);
+  if (!item)
+    return false;
+  if (value.canConvert(QVariant::Map))
+  {
+    // replace the whole map, reusing the unchanged part of the subtree (notifies by itself)
+    reconcileItem(item,value.toMap());
+    return true;
+  }
+  else
+  {
+    // replace data at the specified JSON tag
+    item->setMapValue(index.column(),value);
+    if (m_batchDepth > 0)
+    {
+      recordChange(item,index.column(),index.column());
+      return true;
+    }
+  }
+  emit dataChanged(index,index);
+
+  return true;
+}
+
+void QJsonTreeModel::setItemValues(QJsonTreeItem *item, const QVariantMap &values)
+{
+  if (!item || item == m_root || values.isEmpty())
+    return;
+
+  int first = -1;
+  int last = -1;
+  for (QVariantMap::const_iterator it = values.constBegin(); it != values.constEnd(); ++it)
+  {
+    item->setMapValue(it.key(),it.value());
+    changedColumns(item,it.key(),&first,&last);
+  }
+  notifyChanged(item,first,last);
+}
+
+void QJsonTreeModel::changedColumns(const QJsonTreeItem *item, const QString &tag, int *first, int *last) const
+{
+  // special tags change the item attributes (readonly, widgets, ...), the whole row is affected
+  if (tag.startsWith('_'))
+  {
+    *first = 0;
+    *last = columnCount() - 1;
+    return;
+  }
+  int column = item->headerIdxByTag(tag);
+  if (column < 0)
+    return;
+  *first = (*first == -1 ? column : qMin(*first,column));
+  *last = qMax(*last,column);
+}
+
+void QJsonTreeModel::notifyChanged(QJsonTreeItem *item, int first, int last)
+{
+  if (first == -1)
+    return;
+
+  if (m_batchDepth > 0)
+    recordChange(item,first,last);
+  else
+    emit dataChanged(createIndex(item->row(),first,item),createIndex(item->row(),last,item));
+}
+
+void QJsonTreeModel::reconcileItem(QJsonTreeItem *item, const QVariantMap &map)
+{
+  // an item built empty elsewhere may still lack the headers and root its children need
+  if (!item->rootItem() || !item->m_headers)
+    item->inheritFromParent(item->parent());
+
+  // own tags first, only the differing cells are notified
+  QVariantMap own = map;
+  QVariantList children = own.take("_children_").toList();
+  if (own != item->m_map)
+  {
+    int first = -1;
+    int last = -1;
+    for (QVariantMap::const_iterator it = own.constBegin(); it != own.constEnd(); ++it)
+    {
+      QVariantMap::const_iterator old = item->m_map.constFind(it.key());
+      if (old == item->m_map.constEnd() || old.value() != it.value())
+        changedColumns(item,it.key(),&first,&last);
+    }
+    for (QVariantMap::const_iterator it = item->m_map.constBegin(); it != item->m_map.constEnd(); ++it)
+    {
+      if (!own.contains(it.key()))
+        changedColumns(item,it.key(),&first,&last);
+    }
+    item->setItemMap(own);
+    notifyChanged(item,first,last);
+  }
+
+  QModelIndex parent = indexByItem(item,0);
+  if (item->canFetchMore())
+  {
+    if (item->childCount() == 0)
+    {
+      // nothing materialized yet, the raw list is just replaced. the view must refresh the expand decoration if it's gone
+      item->m_pendingChildren = children;
+      if (children.isEmpty())
+        notifyChanged(item,0,0);
+      return;
+    }
+    fetchAll(parent,false);
+  }
+  else if (item->childCount() == 0 && !children.isEmpty() && item->lazyLoading())
+  {
+    item->m_pendingChildren = children;
+    notifyChanged(item,0,0);
+    return;
+  }
+
+  // match the new children against the existing ones, by name or (unnamed ones) by position
+  int count = item->childCount();
+  QHash<QString, QList<int> > byName;
+  for (int i = 0; i < count; i++)
+  {
+    QString name = item->child(i)->m_map.value("name").toString();
+    if (!name.isEmpty())
+      byName[name].append(i);
+  }
+
+  QList<QVariantMap> maps;
+  QVector<int> candidates(children.count(),-1);
+  for (int j = 0; j < children.count(); j++)
+  {
+    maps.append(children.at(j).toMap());
+    QString name = maps.last().value("name").toString();
+    int old = -1;
+    if (!name.isEmpty())
+    {
+      QHash<QString, QList<int> >::iterator it = byName.find(name);
+      if (it != byName.end() && !it.value().isEmpty())
+        old = it.value().takeFirst();
+    }
+    else if (j < count && item->child(j)->m_map.value("name").toString().isEmpty())
+    {
+      old = j;
+    }
+    candidates[j] = old;
+  }
+
+  // matched children must keep their relative order: the longest run of matches in increasing old row is kept,
+  // the ones out of it (moved) are removed and rebuilt
+  QVector<int> tails; // by run length, the new row ending the run with the lowest old row
+  QVector<int> prev(children.count(),-1);
+  for (int j = 0; j < children.count(); j++)
+  {
+    int old = candidates.at(j);
+    if (old == -1)
+      continue;
+    int lo = 0;
+    int hi = tails.count();
+    while (lo < hi)
+    {
+      int mid = (lo + hi) / 2;
+      if (candidates.at(tails.at(mid)) < old)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    if (lo > 0)
+      prev[j] = tails.at(lo - 1);
+    if (lo == tails.count())
+      tails.append(j);
+    else
+      tails[lo] = j;
+  }
+  QVector<int> matches(children.count(),-1);
+  QVector<bool> kept(count,false);
+  for (int j = (tails.isEmpty() ? -1 : tails.last()); j != -1; j = prev.at(j))
+  {
+    matches[j] = candidates.at(j);
+    kept[candidates.at(j)] = true;
+  }
+
+  // remove the unmatched children, one notification per contiguous range
+  int i = count - 1;
+  while (i >= 0)
+  {
+    if (kept.at(i))
+    {
+      i--;
+      continue;
+    }
+    int last = i;
+    while (i >= 0 && !kept.at(i))
+      i--;
+    removeRows(i + 1,last - i,parent);
+  }
+
+  // recurse into the kept children and insert the new ones in between
+  int row = 0;
+  int j = 0;
+  while (j < maps.count())
+  {
+    if (matches.at(j) != -1)
+    {
+      reconcileItem(item->child(row),maps.at(j));
+      row++;
+      j++;
+      continue;
+    }
+    QList<QVariantMap> added;
+    while (j < maps.count() && matches.at(j) == -1)
+      added.append(maps.at(j++));
+    insertChildren(parent,row,added);
+    row += added.count();
+  }
+}
+
+void QJsonTreeModel::recordChange(QJsonTreeItem *item, int first, int last)
+{
+  QHash<QJsonTreeItem*, QPair<int,int> >::iterator it = m_batchChanges.find(item);
+  if (it == m_batchChanges.end())
+  {
+    m_batchChanges.insert(item,qMakePair(first,last));
+    return;
+  }
+  it.value().first = qMin(it.value().first,first);
+  it.value().second = qMax(it.value().second,last);
+}
+
+void QJsonTreeModel::endBatch()
+{
+  if (m_batchDepth == 0)
+    return;
+  if (--m_batchDepth == 0)
+    flushBatch();
+}
+
+void QJsonTreeModel::flushBatch()
+{
+  if (m_batchChanges.isEmpty())
+    return;
+
+  // group the changed items by parent, rows in order (rows are read now, they may have moved during the batch)
+  QHash<QJsonTreeItem*, QMap<int, QPair<int,int> > > parents;
+  for (QHash<QJsonTreeItem*, QPair<int,int> >::const_iterator it = m_batchChanges.constBegin(); it != m_batchChanges.constEnd(); ++it)
+  {
+    parents[it.key()->parent()].insert(it.key()->row(),it.value());
+  }
+  m_batchChanges.clear();
+
+  // consecutive rows become a single range, spanning all their changed columns
+  for (QHash<QJsonTreeItem*, QMap<int, QPair<int,int> > >::const_iterator p = parents.constBegin(); p != parents.constEnd(); ++p)
+  {
+    QJsonTreeItem* parent = p.key();
+    const QMap<int, QPair<int,int> >& rows = p.value();
+    QMap<int, QPair<int,int> >::const_iterator r = rows.constBegin();
+    while (r != rows.constEnd())
+    {
+      int top = r.key();
+      int bottom = top;
+      int left = r.value().first;
+      int right = r.value().second;
+      for (++r; r != rows.constEnd() && r.key() == bottom + 1; ++r)
+      {
+        bottom++;
+        left = qMin(left,r.value().first);
+        right = qMax(right,r.value().second);
+      }
+      emit dataChanged(createIndex(top,left,parent->child(top)),createIndex(bottom,right,parent->child(bottom)));
+    }
+  }
+}
+
+Qt::ItemFlags QJsonTreeModel::flags(const QModelIndex &index) const
+{
+  // default
+  Qt::ItemFlags f = QAbstractItemModel::flags(index);
+
+  // get item for this index
+  QJsonTreeItem* item = itemByModelIndex(index);
+  if (!item || item->m_map.isEmpty())
+    return f;
+
+  // if it's readonly, remove the enabled flag
+  int column = index.column();
+  if (item->isColumnReadOnly(column) && (m_specialFlags & QJsonTreeItem::HonorReadOnly))
+  {
+    f &= ~Qt::ItemIsEnabled;
+  }
+
+  // if it's a widget, get flags to apply for the widget type
+  f |= QJsonTreeItem::widgetTypeFlags(item->widgetType(column));
+  return f;
+}
+
+QVariant QJsonTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  Q_UNUSED(orientation);
+  if (!m_root)
+    return QVariant();
+
+  if (role == Qt::DisplayRole)
+    return m_root->headerNameByIdx(section);
+  return QVariant();
+}
+
+bool QJsonTreeModel::removeRows(int row, int count, const QModelIndex &parent)
+{
+  QJsonTreeItem* parentit = parentItem(parent);
+  if (!parentit || count <= 0 || row < 0 || row + count > parentit->childCount())
+    return false;
+
+  // changes recorded by a batch refer to items which may be deleted now
+  flushBatch();
+
+  // the whole range is removed (and deleted) at once
+  beginRemoveRows(parent,row,row+count-1);
+  parentit->removeChildren(row,count);
+  endRemoveRows();
+  return true;
+}
+
+bool QJsonTreeModel::insertRows(int row, int count, const QModelIndex &parent)
+{
+  QJsonTreeItem* parentit = parentItem(parent);
+  if (!parentit || count <= 0 || row < 0 || row > parentit->childCount())
+    return false;
+
+  // the new (empty) items are built before notifying. they get the parent headers and root, as items built from a map do
+  QList<QJsonTreeItem*> items;
+  items.reserve(count);
+  for (int i = 0; i < count; i++)
+  {
+    QJsonTreeItem* item = new (parentit->arena()) QJsonTreeItem(parentit->widget(),parentit);
+    item->inheritFromParent(parentit);
+    items.append(item);
+  }
+
+  beginInsertRows(parent,row,row+count-1);
+  parentit->insertChildren(row,items);
+  endInsertRows();
+  indexChildren(parentit,row,count);
+  return true;
+}
+
+bool QJsonTreeModel::insertChildren(const QModelIndex &parent, int row, const QList<QVariantMap> &maps)
+{
+  QJsonTreeItem* parentit = parentItem(parent);
+  if (!parentit || maps.isEmpty() || row < 0 || row > parentit->childCount())
+    return false;
+
+  // the whole subtrees are built before notifying
+  QList<QJsonTreeItem*> items;
+  items.reserve(maps.count());
+  foreach (QVariantMap m, maps)
+    items.append(new (parentit->arena()) QJsonTreeItem(parentit->widget(),parentit,m));
+
+  beginInsertRows(parent,row,row+maps.count()-1);
+  parentit->insertChildren(row,items);
+  endInsertRows();
+  if (m_searchIndex)
+  {
+    foreach (QJsonTreeItem* i, items)
+      m_searchIndex->addSubtree(i);
+  }
+  return true;
+}
+
+bool QJsonTreeModel::insertRow(int row, const QModelIndex &parent)
+{
+  return insertRows(row,1,parent);
+}
+
+bool QJsonTreeModel::hasChildren(const QModelIndex &parent) const
+{
+  // since it's a tree, consider column 0 only
+  if (parent.column() > 0)
+    return false;
+
+  // children not materialized yet counts too, so the view shows the expand decoration
+  QJsonTreeItem* item = parentItem(parent);
+  if (item && item->hasChildren())
+    return true;
+  return false;
+}
+
+bool QJsonTreeModel::canFetchMore(const QModelIndex &parent) const
+{
+  if (parent.column() > 0)
+    return false;
+
+  QJsonTreeItem* item = parentItem(parent);
+  if (item && item->canFetchMore())
+    return true;
+  return false;
+}
+
+void QJsonTreeModel::fetchMore(const QModelIndex &parent)
+{
+  QJsonTreeItem* item = parentItem(parent);
+  if (!item || !item->canFetchMore())
+    return;
+
+  int count = qMin(item->pendingChildCount(),JSON_TREE_FETCH_SIZE);
+  int first = item->childCount();
+  beginInsertRows(parent,first,first + count - 1);
+  item->fetchMore(count);
+  indexChildren(item,first);
+  endInsertRows();
+}
+
+void QJsonTreeModel::fetchAll(const QModelIndex &parent, bool recursive)
+{
+  QJsonTreeItem* item = parentItem(parent);
+  if (!item)
+    return;
+
+  if (item->canFetchMore())
+  {
+    int count = item->pendingChildCount();
+    int first = item->childCount();
+    beginInsertRows(parent,first,first + count - 1);
+    item->fetchMore(count);
+    indexChildren(item,first);
+    endInsertRows();
+  }
+
+  if (!recursive)
+    return;
+  foreach (QJsonTreeItem* i, item->children())
+  {
+    // recurse
+    if (i->hasChildren())
+      fetchAll(indexByItem(i,0),true);
+  }
+}
+
+int QJsonTreeModel::rowCount(const QModelIndex &parent) const
+{
+  // since it's a tree, consider column 0 only
+  if (parent.column() > 0)
+    return 0;
+
+  QJsonTreeItem* item = parentItem(parent);
+  if (item == 0)
+    return 0;
+
+  // simply return item children count (= rows under that item)
+  return item->childCount();
+}
+
+void QJsonTreeModel::clear()
+{
+  beginResetModel();
+  m_batchChanges.clear();
+  if (m_searchIndex)
+    m_searchIndex->clear();
+  if (m_root)
+  {
+    delete m_root;
+    m_root = 0;
+  }
+  endResetModel();
+}
+
+void QJsonTreeModel::setSpecialFlags(QJsonTreeItem::SpecialFlags flags)
+{
+  // special flags is updated, so we need to change the layout and inform the view
+  emit layoutAboutToBeChanged();
+  m_specialFlags = flags;
+  emit layoutChanged();
+}
+
+QJsonTreeItem *QJsonTreeModel::itemByModelIndex(const QModelIndex &index, int role) const
+{
+  // check if index is valid and one of these roles is requested
+  if (!index.isValid())
+    return 0;
+  switch (role)
+  {
+    case Qt::DisplayRole:
+    case Qt::EditRole:
+    case Qt::FontRole:
+    case Qt::BackgroundRole:
+    case Qt::ForegroundRole:
+    case Qt::ToolTipRole:
+      break;
+    default:
+      return 0;
+  }
+
+  // get item
+  return static_cast<QJsonTreeItem*>(index.internalPointer());
+}
+
+QVariantMap QJsonTreeModel::mapByModelIndex(const QModelIndex &index, QJsonTreeItem** item, int role) const
+{
+  QJsonTreeItem* it = itemByModelIndex(index,role);
+  if (!it)
+    return QVariantMap();
+
+  if (item)
+    *item = it;
+
+  // get item map
+  return it->map();
+}
+
+const QString QJsonTreeModel::tagByModelIndex (const QModelIndex &index, QJsonTreeItem** item, int role) const
+{
+  // get item data (without copying its map)
+  QJsonTreeItem* it = itemByModelIndex(index,role);
+  if (!it || it->m_map.isEmpty())
+    return QString();
+  if (item)
+    *item = it;
+  return it->headerTagByIdx(index.column());
+}
+
+const QModelIndex QJsonTreeModel::indexByItem(QJsonTreeItem* item, int column) const
+{
+  if (item == m_root)
+    return QModelIndex();
+  // the item keeps its row, no need to look it up in the parent children
+  return createIndex (item->row(),column,item);
+}
@@ -0,0 +1,421 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qjsontreequery.h"
+#include "qjsontreeitem.h"
+
+QJsonTreeQuery::QJsonTreeQuery()
+{
+  m_pos = 0;
+  m_errorPos = -1;
+  m_root = -1;
+  m_nameTag = "name";
+}
+
+QJsonTreeQuery::QJsonTreeQuery(const QString &query)
+{
+  m_nameTag = "name";
+  compile(query);
+}
+
+bool QJsonTreeQuery::compile(const QString &query)
+{
+  m_pattern = query;
+  m_pos = 0;
+  m_errorString.clear();
+  m_errorPos = -1;
+  m_nodes.clear();
+  m_root = -1;
+
+  skipWhitespace();
+  if (m_pos >= m_pattern.length())
+    return true;
+
+  int root = parseOr();
+  if (root != -1)
+  {
+    skipWhitespace();
+    if (m_pos < m_pattern.length())
+      root = setError(QObject::tr("syntax error, unexpected '%1'").arg(m_pattern.mid(m_pos)));
+  }
+  if (root == -1)
+  {
+    m_nodes.clear();
+    return false;
+  }
+  m_root = root;
+  return true;
+}
+
+int QJsonTreeQuery::setError(const QString &error)
+{
+  // keep the first error only
+  if (m_errorString.isEmpty())
+  {
+    m_errorString = error;
+    m_errorPos = m_pos;
+  }
+  return -1;
+}
+
+void QJsonTreeQuery::skipWhitespace()
+{
+  while (m_pos < m_pattern.length() && m_pattern.at(m_pos).isSpace())
+    m_pos++;
+}
+
+static bool isDelimiter(QChar c)
+{
+  return (c.isSpace() || QString("()=!<>~\"'&|").contains(c));
+}
+
+QString QJsonTreeQuery::token()
+{
+  // a path or a bare value, up to the next operator or blank
+  skipWhitespace();
+  int start = m_pos;
+  while (m_pos < m_pattern.length() && !isDelimiter(m_pattern.at(m_pos)))
+    m_pos++;
+  return m_pattern.mid(start,m_pos - start);
+}
+
+bool QJsonTreeQuery::acceptKeyword(const char *keyword, const char *symbol)
+{
+  skipWhitespace();
+  QString sym = QString::fromLatin1(symbol);
+  if (m_pattern.midRef(m_pos,sym.length()) == sym)
+  {
+    // "!" is not, "!=" is an operator
+    if (sym != "!" || m_pattern.midRef(m_pos,2) != QLatin1String("!="))
+    {
+      m_pos += sym.length();
+      return true;
+    }
+  }
+
+  QString kw = QString::fromLatin1(keyword);
+  int end = m_pos + kw.length();
+  if (m_pattern.midRef(m_pos,kw.length()).compare(kw,Qt::CaseInsensitive) != 0)
+    return false;
+  if (end < m_pattern.length() && !m_pattern.at(end).isSpace() && m_pattern.at(end) != '(')
+    return false;
+  m_pos = end;
+  return true;
+}
+
+int QJsonTreeQuery::addNode(int op, int left, int right)
+{
+  QJsonTreeQueryNode n;
+  n.op = op;
+  n.left = left;
+  n.right = right;
+  n.anchored = false;
+  n.valueType = QJsonTreeQueryNode::String;
+  n.number = 0;
+  n.boolean = false;
+  m_nodes.append(n);
+  return m_nodes.count() - 1;
+}
+
+int QJsonTreeQuery::parseOr()
+{
+  int left = parseAnd();
+  while (left != -1 && acceptKeyword("or","||"))
+  {
+    int right = parseAnd();
+    if (right == -1)
+      return -1;
+    left = addNode(QJsonTreeQueryNode::Or,left,right);
+  }
+  return left;
+}
+
+int QJsonTreeQuery::parseAnd()
+{
+  int left = parseNot();
+  while (left != -1 && acceptKeyword("and","&&"))
+  {
+    int right = parseNot();
+    if (right == -1)
+      return -1;
+    left = addNode(QJsonTreeQueryNode::And,left,right);
+  }
+  return left;
+}
+
+int QJsonTreeQuery::parseNot()
+{
+  if (acceptKeyword("not","!"))
+  {
+    int operand = parseNot();
+    if (operand == -1)
+      return -1;
+    return addNode(QJsonTreeQueryNode::Not,operand,-1);
+  }
+  return parsePrimary();
+}
+
+int QJsonTreeQuery::parsePrimary()
+{
+  skipWhitespace();
+  if (m_pos < m_pattern.length() && m_pattern.at(m_pos) == '(')
+  {
+    m_pos++;
+    int n = parseOr();
+    if (n == -1)
+      return -1;
+    skipWhitespace();
+    if (m_pos >= m_pattern.length() || m_pattern.at(m_pos) != ')')
+      return setError(QObject::tr("syntax error, expected ')'"));
+    m_pos++;
+    return n;
+  }
+  return parseComparison();
+}
+
+int QJsonTreeQuery::parseComparison()
+{
+  QString path = token();
+  if (path.isEmpty())
+    return setError(QObject::tr("syntax error, expected a path"));
+
+  int idx = addNode(QJsonTreeQueryNode::Exists,-1,-1);
+  QJsonTreeQueryNode& n = m_nodes[idx];
+
+  // the last segment is the tag, the others match the item and its ancestors names
+  n.anchored = path.startsWith('/');
+  QStringList segments = path.split('/',QString::SkipEmptyParts);
+  if (segments.isEmpty() || path.endsWith('/'))
+    return setError(QObject::tr("syntax error, expected a tag in '%1'").arg(path));
+  n.tag = segments.takeLast();
+  foreach (QString s, segments)
+  {
+    if (s == "*")
+      n.path.append(QRegExp());
+    else if (s.contains('*') || s.contains('?'))
+      n.path.append(QRegExp(s,Qt::CaseInsensitive,QRegExp::Wildcard));
+    else
+      n.path.append(QRegExp(s,Qt::CaseInsensitive,QRegExp::FixedString));
+  }
+
+  // the operator, if any
+  skipWhitespace();
+  static const char* ops[] = { "==", "!=", "<=", ">=", "=", "<", ">", "~" };
+  static const int opcodes[] = { QJsonTreeQueryNode::Equal, QJsonTreeQueryNode::NotEqual, QJsonTreeQueryNode::LessEqual, QJsonTreeQueryNode::GreaterEqual,
+                                 QJsonTreeQueryNode::Equal, QJsonTreeQueryNode::Less, QJsonTreeQueryNode::Greater, QJsonTreeQueryNode::Match };
+  for (int i=0; i < 8; i++)
+  {
+    QString op = QString::fromLatin1(ops[i]);
+    if (m_pattern.midRef(m_pos,op.length()) == op)
+    {
+      m_pos += op.length();
+      n.op = opcodes[i];
+      if (!parseValue(&n))
+        return -1;
+      break;
+    }
+  }
+  return idx;
+}
+
+bool QJsonTreeQuery::parseValue(QJsonTreeQueryNode *n)
+{
+  skipWhitespace();
+  if (m_pos >= m_pattern.length())
+  {
+    setError(QObject::tr("syntax error, expected a value"));
+    return false;
+  }
+
+  QChar c = m_pattern.at(m_pos);
+  bool quoted = (c == '"' || c == '\'' || (c == '/' && n->op == QJsonTreeQueryNode::Match));
+  QString value;
+  Qt::CaseSensitivity cs = Qt::CaseSensitive;
+  if (quoted)
+  {
+    // up to the closing delimiter, which can be escaped with a backslash
+    m_pos++;
+    bool closed = false;
+    while (m_pos < m_pattern.length())
+    {
+      QChar v = m_pattern.at(m_pos++);
+      if (v == c)
+      {
+        closed = true;
+        break;
+      }
+      if (v == '\\' && m_pos < m_pattern.length() && m_pattern.at(m_pos) == c)
+        v = m_pattern.at(m_pos++);
+      else if (v == '\\' && c != '/' && m_pos < m_pattern.length())
+        v = m_pattern.at(m_pos++);
+      value.append(v);
+    }
+    if (!closed)
+    {
+      setError(QObject::tr("syntax error, expected '%1'").arg(c));
+      return false;
+    }
+
+    // regular expression flags
+    if (c == '/' && m_pos < m_pattern.length() && m_pattern.at(m_pos) == 'i')
+    {
+      cs = Qt::CaseInsensitive;
+      m_pos++;
+    }
+  }
+  else
+  {
+    value = token();
+    if (value.isEmpty())
+    {
+      setError(QObject::tr("syntax error, expected a value"));
+      return false;
+    }
+  }
+
+  // typed values are compiled once
+  n->text = value;
+  if (n->op == QJsonTreeQueryNode::Match)
+  {
+    n->valueType = QJsonTreeQueryNode::RegExp;
+    n->rx = QRegExp(value,cs,QRegExp::RegExp2);
+    if (!n->rx.isValid())
+    {
+      setError(QObject::tr("invalid regular expression '%1': %2").arg(value).arg(n->rx.errorString()));
+      return false;
+    }
+    return true;
+  }
+  if (quoted)
+    return true;
+
+  bool ok = false;
+  n->number = value.toDouble(&ok);
+  if (ok)
+  {
+    n->valueType = QJsonTreeQueryNode::Number;
+    return true;
+  }
+  if (value == "true" || value == "false")
+  {
+    if (n->op != QJsonTreeQueryNode::Equal && n->op != QJsonTreeQueryNode::NotEqual)
+    {
+      setError(QObject::tr("syntax error, booleans can only be compared with == and !="));
+      return false;
+    }
+    n->valueType = QJsonTreeQueryNode::Bool;
+    n->boolean = (value == "true");
+  }
+  return true;
+}
+
+bool QJsonTreeQuery::evaluate(int node, const QJsonTreeItem *item) const
+{
+  const QJsonTreeQueryNode& n = m_nodes.at(node);
+  switch (n.op)
+  {
+    case QJsonTreeQueryNode::And:
+      return (evaluate(n.left,item) && evaluate(n.right,item));
+    case QJsonTreeQueryNode::Or:
+      return (evaluate(n.left,item) || evaluate(n.right,item));
+    case QJsonTreeQueryNode::Not:
+      return !evaluate(n.left,item);
+    default:
+      break;
+  }
+
+  // the path names the item and its ancestors, going up (the invisible root has no name)
+  const QJsonTreeItem* it = item;
+  for (int i=n.path.count() - 1; i >= 0; i--)
+  {
+    if (!it || !it->parent())
+      return false;
+    const QRegExp& rx = n.path.at(i);
+    if (!rx.isEmpty() && !rx.exactMatch(it->m_map.value(m_nameTag).toString()))
+      return false;
+    it = it->parent();
+  }
+  if (n.anchored && (!it || it->parent()))
+    return false;
+
+  // the value is read in place, missing tags never match
+  QVariantMap::const_iterator v = item->m_map.constFind(n.tag);
+  if (v == item->m_map.constEnd())
+    return false;
+  if (n.op == QJsonTreeQueryNode::Exists)
+    return true;
+  return compareValue(n,v.value());
+}
+
+bool QJsonTreeQuery::compareValue(const QJsonTreeQueryNode &n, const QVariant &v) const
+{
+  int res = 0;
+  switch (n.valueType)
+  {
+    case QJsonTreeQueryNode::RegExp:
+      return (n.rx.indexIn(v.toString()) != -1);
+
+    case QJsonTreeQueryNode::Bool:
+    {
+      // values edited in the view may be strings
+      bool b;
+      if (v.type() == QVariant::Bool)
+        b = v.toBool();
+      else if (v.toString().compare("true",Qt::CaseInsensitive) == 0)
+        b = true;
+      else if (v.toString().compare("false",Qt::CaseInsensitive) == 0)
+        b = false;
+      else
+        return false;
+      return ((n.op == QJsonTreeQueryNode::Equal) == (b == n.boolean));
+    }
+
+    case QJsonTreeQueryNode::Number:
+    {
+      bool ok = false;
+      double d = v.toDouble(&ok);
+      if (!ok)
+        return false;
+      res = (d < n.number ? -1 : (d > n.number ? 1 : 0));
+    }
+    break;
+
+    default:
+      res = QString::compare(v.toString(),n.text);
+    break;
+  }
+
+  switch (n.op)
+  {
+    case QJsonTreeQueryNode::Equal:
+      return (res == 0);
+    case QJsonTreeQueryNode::NotEqual:
+      return (res != 0);
+    case QJsonTreeQueryNode::Less:
+      return (res < 0);
+    case QJsonTreeQueryNode::LessEqual:
+      return (res <= 0);
+    case QJsonTreeQueryNode::Greater:
+      return (res > 0);
+    case QJsonTreeQueryNode::GreaterEqual:
+      return (res >= 0);
+    default:
+      return false;
+  }
+}
@@ -0,0 +1,171 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QJSONTREEQUERY_H
+#define QJSONTREEQUERY_H
+
+#include <QtCore>
+
+class QJsonTreeItem;
+
+/**
+ * @brief a node of a compiled query: a boolean operator on other nodes, or a test on a single item tag
+ *
+ */
+struct QJsonTreeQueryNode
+{
+  enum Op {
+    And = 0,
+    Or,
+    Not,
+    Exists,
+    Equal,
+    NotEqual,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    Match
+  };
+  enum ValueType {
+    String = 0,
+    Number,
+    Bool,
+    RegExp
+  };
+
+  int op;
+  int left; // operands of And/Or/Not
+  int right;
+
+  bool anchored; // the path starts with '/', the first segment is a top level item
+  QVector<QRegExp> path; // names of the item (last) and its ancestors, an empty QRegExp matches any name
+  QString tag; // the tested JSON tag
+  int valueType;
+  double number;
+  bool boolean;
+  QString text;
+  QRegExp rx;
+};
+
+/**
+ * @brief a structured query on the items, compiled once into a predicate tree evaluated directly against the items maps.
+ *
+ * the syntax is:
+ * - comparisons: path op value, where op is one of == (or =), !=, <, <=, >, >=, ~ (regular expression match). path alone tests the tag is present
+ * - path: [/]name/.../tag. tag is the JSON tag tested on the item (i.e. "value", "_widget_:value"). the preceding segments match the "name" tag
+ *   of the item (the last one) and of its ancestors going up, with * and ? wildcards. a leading '/' anchors the first segment to a top level item
+ * - values: numbers and true/false compare as such, "quoted" or bare strings compare as text, /regexp/ (with the optional i flag) after ~
+ * - comparisons combine with and (&&), or (||), not (!) and parentheses
+ *
+ * i.e. /servers/srv?/port > 8000, name ~ /db.+/i, _widget_:value == QCheckBox and value == true
+ *
+ */
+class QJsonTreeQuery
+{
+public:
+  /**
+   * @brief constructor, builds an empty query
+   *
+   */
+  QJsonTreeQuery();
+
+  /**
+   * @brief constructor, compiles the query (check isValid())
+   *
+   * @param query the query string
+   */
+  explicit QJsonTreeQuery(const QString& query);
+
+  /**
+   * @brief compiles the query, replacing the current one
+   *
+   * @param query the query string
+   * @return bool false on syntax error (see errorString())
+   */
+  bool compile(const QString& query);
+
+  /**
+   * @brief returns whether the query is empty (an empty query matches every item)
+   *
+   * @return bool
+   */
+  bool isEmpty() const { return m_nodes.isEmpty(); }
+
+  /**
+   * @brief returns whether the query compiled succesfully
+   *
+   * @return bool
+   */
+  bool isValid() const { return m_errorString.isEmpty(); }
+
+  /**
+   * @brief returns the query string
+   *
+   * @return QString
+   */
+  QString pattern() const { return m_pattern; }
+
+  /**
+   * @brief returns the syntax error
+   *
+   * @return QString
+   */
+  QString errorString() const { return m_errorString; }
+
+  /**
+   * @brief returns the position of the syntax error in the query string
+   *
+   * @return int
+   */
+  int errorPosition() const { return m_errorPos; }
+
+  /**
+   * @brief evaluates the query on the item (not thread safe, the regular expressions keep their matching state)
+   *
+   * @param item the item
+   * @return bool
+   */
+  bool matches(const QJsonTreeItem* item) const { return (m_nodes.isEmpty() || evaluate(m_root,item)); }
+
+private:
+  bool evaluate(int node, const QJsonTreeItem* item) const;
+  bool compareValue(const QJsonTreeQueryNode& n, const QVariant& v) const;
+  int addNode(int op, int left, int right);
+  int parseOr();
+  int parseAnd();
+  int parseNot();
+  int parsePrimary();
+  int parseComparison();
+  bool parseValue(QJsonTreeQueryNode* n);
+  bool acceptKeyword(const char* keyword, const char* symbol);
+  QString token();
+  void skipWhitespace();
+  int setError(const QString& error);
+
+  QString m_pattern;
+  int m_pos;
+  QString m_errorString;
+  int m_errorPos;
+  QVector<QJsonTreeQueryNode> m_nodes;
+  int m_root;
+  QString m_nameTag;
+};
+
+#endif // QJSONTREEQUERY_H
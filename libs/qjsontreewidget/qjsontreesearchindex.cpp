@@ -0,0 +1,387 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qjsontreesearchindex.h"
+#include "qjsontreeitem.h"
+
+static inline quint64 packTrigram(const QChar* c)
+{
+  return (quint64(c[0].unicode()) << 32) | (quint64(c[1].unicode()) << 16) | quint64(c[2].unicode());
+}
+
+void QJsonTreeSearchIndex::clear()
+{
+  foreach (const QJsonTreeItem* item, m_itemTrigrams.keys())
+  {
+    const_cast<QJsonTreeItem*>(item)->m_attributes &= ~QJsonTreeItem::AttrIndexed;
+  }
+  m_postings.clear();
+  m_itemTrigrams.clear();
+}
+
+void QJsonTreeSearchIndex::addItem(QJsonTreeItem *item)
+{
+  if (item->m_attributes & QJsonTreeItem::AttrIndexed)
+    removeItem(item);
+
+  // the same columns text the proxy model filter checks
+  QSet<quint64> set;
+  for (int i=0; i < item->columnCount(); i++)
+  {
+    trigrams(item->text(i),&set);
+  }
+
+  QVector<quint64> v;
+  v.reserve(set.count());
+  foreach (quint64 t, set)
+  {
+    m_postings[t].insert(item);
+    v.append(t);
+  }
+  qSort(v);
+  m_itemTrigrams.insert(item,v);
+  item->m_attributes |= QJsonTreeItem::AttrIndexed;
+}
+
+void QJsonTreeSearchIndex::addSubtree(QJsonTreeItem *item)
+{
+  addItem(item);
+  foreach (QJsonTreeItem* child, item->children())
+  {
+    // recurse
+    addSubtree(child);
+  }
+}
+
+void QJsonTreeSearchIndex::removeItem(QJsonTreeItem *item)
+{
+  QHash<const QJsonTreeItem*, QVector<quint64> >::iterator it = m_itemTrigrams.find(item);
+  item->m_attributes &= ~QJsonTreeItem::AttrIndexed;
+  if (it == m_itemTrigrams.end())
+    return;
+
+  foreach (quint64 t, it.value())
+  {
+    QHash<quint64, QSet<QJsonTreeItem*> >::iterator p = m_postings.find(t);
+    if (p == m_postings.end())
+      continue;
+    p.value().remove(item);
+    if (p.value().isEmpty())
+      m_postings.erase(p);
+  }
+  m_itemTrigrams.erase(it);
+}
+
+QJsonTreeSearchIndex::Query QJsonTreeSearchIndex::compile(const QRegExp &rx)
+{
+  Query q;
+  QStringList literals = requiredLiterals(rx,&q.m_restricted);
+  if (!q.m_restricted)
+    return q;
+
+  QSet<quint64> set;
+  foreach (QString l, literals)
+  {
+    trigrams(l,&set);
+  }
+  q.m_trigrams.reserve(set.count());
+  foreach (quint64 t, set)
+  {
+    q.m_trigrams.append(t);
+  }
+  qSort(q.m_trigrams);
+  return q;
+}
+
+bool QJsonTreeSearchIndex::mayMatch(const QJsonTreeItem *item, const Query &query) const
+{
+  if (!query.m_restricted)
+    return true;
+  QHash<const QJsonTreeItem*, QVector<quint64> >::const_iterator it = m_itemTrigrams.constFind(item);
+  if (it == m_itemTrigrams.constEnd())
+    return true;
+
+  // both are sorted, check the query trigrams are a subset of the item ones
+  const QVector<quint64>& v = it.value();
+  QVector<quint64>::const_iterator pos = v.constBegin();
+  foreach (quint64 t, query.m_trigrams)
+  {
+    pos = qLowerBound(pos,v.constEnd(),t);
+    if (pos == v.constEnd() || *pos != t)
+      return false;
+  }
+  return true;
+}
+
+QSet<QJsonTreeItem*> QJsonTreeSearchIndex::candidates(const Query &query) const
+{
+  if (!query.m_restricted)
+    return QSet<QJsonTreeItem*>();
+
+  // start from the shortest posting list, then intersect
+  QList<const QSet<QJsonTreeItem*>*> postings;
+  foreach (quint64 t, query.m_trigrams)
+  {
+    QHash<quint64, QSet<QJsonTreeItem*> >::const_iterator p = m_postings.constFind(t);
+    if (p == m_postings.constEnd())
+      return QSet<QJsonTreeItem*>();
+    postings.append(&p.value());
+  }
+  if (postings.isEmpty())
+    return QSet<QJsonTreeItem*>();
+
+  int shortest = 0;
+  for (int i=1; i < postings.count(); i++)
+  {
+    if (postings.at(i)->count() < postings.at(shortest)->count())
+      shortest = i;
+  }
+
+  QSet<QJsonTreeItem*> result;
+  foreach (QJsonTreeItem* item, *postings.at(shortest))
+  {
+    bool all = true;
+    for (int i=0; i < postings.count() && all; i++)
+    {
+      if (i != shortest && !postings.at(i)->contains(item))
+        all = false;
+    }
+    if (all)
+      result.insert(item);
+  }
+  return result;
+}
+
+QStringList QJsonTreeSearchIndex::requiredLiterals(const QRegExp &rx, bool *restricted)
+{
+  // collects the literal runs every match must contain. anything which can't be proven required (alternations, optional characters,
+  // groups, classes) just ends the current run
+  *restricted = false;
+  QStringList literals;
+  QString pattern = rx.pattern();
+  QString cur;
+  int n = pattern.size();
+
+  switch (rx.patternSyntax())
+  {
+    case QRegExp::FixedString:
+      literals.append(pattern);
+    break;
+
+    case QRegExp::Wildcard:
+    case QRegExp::WildcardUnix:
+      for (int i=0; i < n; i++)
+      {
+        QChar c = pattern.at(i);
+        if (c == '\\' && rx.patternSyntax() == QRegExp::WildcardUnix && i + 1 < n)
+        {
+          cur.append(pattern.at(++i));
+        }
+        else if (c == '*' || c == '?' || c == '[' || c == ']')
+        {
+          literals.append(cur);
+          cur.clear();
+          if (c == '[')
+          {
+            // skip the set
+            while (i + 1 < n && pattern.at(i + 1) != ']')
+              i++;
+          }
+        }
+        else
+        {
+          cur.append(c);
+        }
+      }
+      literals.append(cur);
+    break;
+
+    case QRegExp::RegExp:
+    case QRegExp::RegExp2:
+    {
+      int i = 0;
+      while (i < n)
+      {
+        QChar c = pattern.at(i);
+        QChar lit;
+        if (c == '|')
+        {
+          // top level alternation, nothing is required
+          return QStringList();
+        }
+        else if (c == '\\')
+        {
+          if (i + 1 < n && !pattern.at(i + 1).isLetterOrNumber())
+          {
+            // escaped literal
+            lit = pattern.at(i + 1);
+            i += 2;
+          }
+          else
+          {
+            // character class (\d, \w, ...), back reference or a code escape: \xhhhh and \0ooo are skipped whole,
+            // their digits aren't literals
+            literals.append(cur);
+            cur.clear();
+            QChar e = (i + 1 < n) ? pattern.at(i + 1) : QChar();
+            i += 2;
+            if (e == 'x')
+            {
+              for (int d = 0; d < 4 && i < n && QString("0123456789abcdefABCDEF").contains(pattern.at(i)); d++)
+                i++;
+            }
+            else if (e == '0')
+            {
+              for (int d = 0; d < 3 && i < n && pattern.at(i) >= '0' && pattern.at(i) <= '7'; d++)
+                i++;
+            }
+            continue;
+          }
+        }
+        else if (c == '[')
+        {
+          // skip the set, ']' right after '[' or '[^' is a literal
+          literals.append(cur);
+          cur.clear();
+          i++;
+          if (i < n && pattern.at(i) == '^')
+            i++;
+          if (i < n && pattern.at(i) == ']')
+            i++;
+          while (i < n && pattern.at(i) != ']')
+          {
+            if (pattern.at(i) == '\\')
+              i++;
+            i++;
+          }
+          i++;
+          continue;
+        }
+        else if (c == '(')
+        {
+          // skip the group, it may be optional or contain alternations
+          literals.append(cur);
+          cur.clear();
+          int depth = 0;
+          while (i < n)
+          {
+            if (pattern.at(i) == '\\')
+              i++;
+            else if (pattern.at(i) == '(')
+              depth++;
+            else if (pattern.at(i) == ')' && --depth == 0)
+              break;
+            i++;
+          }
+          i++;
+          continue;
+        }
+        else if (c == '.' || c == '^' || c == '$' || c == '*' || c == '+' || c == '?' || c == '{' || c == '}' || c == ')')
+        {
+          literals.append(cur);
+          cur.clear();
+          i++;
+          continue;
+        }
+        else
+        {
+          lit = c;
+          i++;
+        }
+
+        // a literal, check whether a quantifier makes it optional
+        QChar q = (i < n) ? pattern.at(i) : QChar();
+        if (q == '*' || q == '?' || q == '{')
+        {
+          literals.append(cur);
+          cur.clear();
+          if (q == '{')
+          {
+            while (i < n && pattern.at(i) != '}')
+              i++;
+          }
+          i++;
+        }
+        else if (q == '+')
+        {
+          // required once at least, but what follows isn't adjacent anymore
+          cur.append(lit);
+          literals.append(cur);
+          cur.clear();
+          i++;
+        }
+        else
+        {
+          cur.append(lit);
+        }
+      }
+      literals.append(cur);
+    }
+    break;
+
+    default:
+      // i.e. W3CXmlSchema11, not handled
+      return QStringList();
+  }
+
+  // case insensitive matching folds single characters, while the index lowercases whole strings: they only agree on ASCII,
+  // so the runs are split there
+  if (rx.caseSensitivity() == Qt::CaseInsensitive)
+  {
+    QStringList ascii;
+    foreach (QString l, literals)
+    {
+      QString run;
+      foreach (QChar c, l)
+      {
+        if (c.unicode() < 0x80)
+        {
+          run.append(c);
+          continue;
+        }
+        ascii.append(run);
+        run.clear();
+      }
+      ascii.append(run);
+    }
+    literals = ascii;
+  }
+
+  // only runs long enough to have a trigram are useful
+  QStringList result;
+  foreach (QString l, literals)
+  {
+    if (l.size() >= 3)
+      result.append(l);
+  }
+  *restricted = !result.isEmpty();
+  return result;
+}
+
+void QJsonTreeSearchIndex::trigrams(const QString &text, QSet<quint64> *out)
+{
+  if (text.size() < 3)
+    return;
+  QString lower = text.toLower();
+  const QChar* c = lower.constData();
+  for (int i=0; i + 2 < lower.size(); i++)
+  {
+    out->insert(packTrigram(c + i));
+  }
+}
@@ -0,0 +1,133 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QJSONTREESEARCHINDEX_H
+#define QJSONTREESEARCHINDEX_H
+
+#include <QtCore>
+
+class QJsonTreeItem;
+
+/**
+ * @brief optional trigram index over the items columns text, kept by QJsonTreeModel (see QJsonTreeWidget::setSearchIndexEnabled()).
+ * it gives fixed string, wildcard and simple regular expression searches a candidate set: only the items containing all the trigrams of the
+ * literal parts the expression requires can match, the others are never checked against the expression.
+ * the text is indexed lowercase, so the candidates are valid for both case sensitive and insensitive searches.
+ *
+ */
+class QJsonTreeSearchIndex
+{
+public:
+  /**
+   * @brief a search expression compiled against the index
+   *
+   */
+  class Query
+  {
+    friend class QJsonTreeSearchIndex;
+  public:
+    Query() { m_restricted = false; }
+
+    /**
+     * @brief returns whether the query restricts the candidates. if not (i.e. the expression has an alternation, or no literal long 3 characters at least),
+     * every item must be checked
+     *
+     * @return bool
+     */
+    bool isRestricted() const { return m_restricted; }
+
+  private:
+    bool m_restricted;
+    QVector<quint64> m_trigrams; // sorted
+  };
+
+  /**
+   * @brief constructor, builds an empty index
+   *
+   */
+  QJsonTreeSearchIndex() {}
+
+  /**
+   * @brief removes all the items from the index
+   *
+   */
+  void clear();
+
+  /**
+   * @brief indexes (or reindexes) the item
+   *
+   * @param item the item
+   */
+  void addItem(QJsonTreeItem* item);
+
+  /**
+   * @brief indexes the item and all its (materialized) descendants
+   *
+   * @param item the item
+   */
+  void addSubtree(QJsonTreeItem* item);
+
+  /**
+   * @brief removes the item from the index (its descendants are left untouched)
+   *
+   * @param item the item
+   */
+  void removeItem(QJsonTreeItem* item);
+
+  /**
+   * @brief returns the number of indexed items
+   *
+   * @return int
+   */
+  int itemCount() const { return m_itemTrigrams.count(); }
+
+  /**
+   * @brief compiles a search expression
+   *
+   * @param rx the expression (as set with QJsonTreeWidget::search())
+   * @return Query
+   */
+  static Query compile(const QRegExp& rx);
+
+  /**
+   * @brief returns whether the item may match the query. items not in the index always may
+   *
+   * @param item the item
+   * @param query the compiled query
+   * @return bool
+   */
+  bool mayMatch(const QJsonTreeItem* item, const Query& query) const;
+
+  /**
+   * @brief returns the indexed items which may match the query
+   *
+   * @param query the compiled query, must be restricted (see Query::isRestricted())
+   * @return QSet<QJsonTreeItem*>
+   */
+  QSet<QJsonTreeItem*> candidates(const Query& query) const;
+
+private:
+  static QStringList requiredLiterals(const QRegExp& rx, bool* restricted);
+  static void trigrams(const QString& text, QSet<quint64>* out);
+
+  QHash<quint64, QSet<QJsonTreeItem*> > m_postings;
+  QHash<const QJsonTreeItem*, QVector<quint64> > m_itemTrigrams; // sorted, to remove/check an item without scanning the postings
+};
+
+#endif // QJSONTREESEARCHINDEX_H
@@ -0,0 +1,83 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qjsontreesearchresults.h"
+
+QJsonTreeSearchResults::QJsonTreeSearchResults(const QModelIndexList &matches)
+{
+  m_position = -1;
+  m_matches.reserve(matches.count());
+  foreach (QModelIndex idx, matches)
+  {
+    m_matches.append(QPersistentModelIndex(idx));
+  }
+}
+
+QModelIndex QJsonTreeSearchResults::first()
+{
+  return step(-1,1);
+}
+
+QModelIndex QJsonTreeSearchResults::last()
+{
+  return step(m_matches.count(),-1);
+}
+
+QModelIndex QJsonTreeSearchResults::next()
+{
+  return step(m_position,1);
+}
+
+QModelIndex QJsonTreeSearchResults::previous()
+{
+  if (m_position == -1)
+    return last();
+  return step(m_position,-1);
+}
+
+QModelIndex QJsonTreeSearchResults::step(int from, int direction)
+{
+  int n = m_matches.count();
+  if (n == 0)
+    return QModelIndex();
+
+  // skip the matches whose row has been removed meanwhile, wrapping around once at most
+  int pos = from;
+  for (int i=0; i < n; i++)
+  {
+    pos += direction;
+    if (pos >= n)
+      pos = 0;
+    else if (pos < 0)
+      pos = n - 1;
+    if (m_matches.at(pos).isValid())
+    {
+      m_position = pos;
+      return m_matches.at(pos);
+    }
+  }
+  return QModelIndex();
+}
+
+QString QJsonTreeSearchResults::positionText() const
+{
+  if (m_matches.isEmpty())
+    return QString();
+  return QObject::tr("%1 of %2").arg(m_position + 1).arg(m_matches.count());
+}
@@ -0,0 +1,131 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QJSONTREESEARCHRESULTS_H
+#define QJSONTREESEARCHRESULTS_H
+
+#include <QtCore>
+
+/**
+ * @brief ordered search results with a cursor, as returned by QJsonTreeWidget::searchResults().
+ * the matches are kept as persistent source model indexes in tree order, so the order and the cursor don't change when the view is sorted.
+ * moving the cursor is O(1), matches whose row has been removed are skipped.
+ *
+ */
+class QJsonTreeSearchResults
+{
+public:
+  /**
+   * @brief constructor, builds an empty result set
+   *
+   */
+  QJsonTreeSearchResults() { m_position = -1; }
+
+  /**
+   * @brief constructor
+   *
+   * @param matches the source model indexes of the matching cells, in tree order
+   */
+  explicit QJsonTreeSearchResults(const QModelIndexList& matches);
+
+  /**
+   * @brief returns the number of matches
+   *
+   * @return int
+   */
+  int count() const { return m_matches.count(); }
+
+  /**
+   * @brief returns whether there are no matches
+   *
+   * @return bool
+   */
+  bool isEmpty() const { return m_matches.isEmpty(); }
+
+  /**
+   * @brief returns the match at position
+   *
+   * @param position the position (0 to count() - 1)
+   * @return QModelIndex the source model index, invalid if the position is invalid or the row has been removed
+   */
+  QModelIndex at(int position) const { return (position >= 0 && position < m_matches.count()) ? QModelIndex(m_matches.at(position)) : QModelIndex(); }
+
+  /**
+   * @brief returns the cursor position
+   *
+   * @return int -1 if the cursor has not been moved yet
+   */
+  int position() const { return m_position; }
+
+  /**
+   * @brief returns the match at the cursor
+   *
+   * @return QModelIndex
+   */
+  QModelIndex current() const { return at(m_position); }
+
+  /**
+   * @brief moves the cursor to the first match
+   *
+   * @return QModelIndex the match, invalid if there's none
+   */
+  QModelIndex first();
+
+  /**
+   * @brief moves the cursor to the last match
+   *
+   * @return QModelIndex the match, invalid if there's none
+   */
+  QModelIndex last();
+
+  /**
+   * @brief moves the cursor to the next match, wrapping to the first one after the last
+   *
+   * @return QModelIndex the match, invalid if there's none
+   */
+  QModelIndex next();
+
+  /**
+   * @brief moves the cursor to the previous match, wrapping to the last one before the first
+   *
+   * @return QModelIndex the match, invalid if there's none
+   */
+  QModelIndex previous();
+
+  /**
+   * @brief returns the cursor position as "n of m"
+   *
+   * @return QString empty if there are no matches
+   */
+  QString positionText() const;
+
+  /**
+   * @brief removes all the matches
+   *
+   */
+  void clear() { m_matches.clear(); m_position = -1; }
+
+private:
+  QModelIndex step(int from, int direction);
+
+  QList<QPersistentModelIndex> m_matches;
+  int m_position;
+};
+
+#endif // QJSONTREESEARCHRESULTS_H
@@ -0,0 +1,65 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qjsontreesearchsession.h"
+#include "qjsontreewidget.h"
+
+QJsonTreeSearchSession::QJsonTreeSearchSession(QJsonTreeWidget *tree, QObject *parent) :
+  QObject(parent)
+{
+  m_tree = tree;
+  m_timer.setSingleShot(true);
+  m_timer.setInterval(250);
+  connect (&m_timer,SIGNAL(timeout()),this,SLOT(searchNow()));
+}
+
+void QJsonTreeSearchSession::setText(const QString &text)
+{
+  m_pendingText = text;
+  if (text.isEmpty())
+  {
+    cancel();
+    if (m_tree && !m_text.isEmpty())
+      m_tree->clearSearch();
+    m_text = QString();
+    return;
+  }
+
+  // restarts the timer, so only the last keystroke of a burst triggers the search
+  m_timer.start();
+}
+
+void QJsonTreeSearchSession::searchNow()
+{
+  m_timer.stop();
+  if (m_pendingText.isEmpty() || !m_tree)
+    return;
+
+  m_text = m_pendingText;
+  m_tree->searchIncremental(m_text);
+  emit searchFinished(m_text,m_tree->searchMatchCount());
+}
+
+void QJsonTreeSearchSession::cancel()
+{
+  if (!m_timer.isActive())
+    return;
+  m_timer.stop();
+  emit canceled();
+}
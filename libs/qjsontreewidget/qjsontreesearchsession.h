@@ -0,0 +1,114 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QJSONTREESEARCHSESSION_H
+#define QJSONTREESEARCHSESSION_H
+
+#include <QtCore>
+
+class QJsonTreeWidget;
+
+/**
+ * @brief search-as-you-type helper: connect a line edit textChanged() signal to setText(), the search runs once the text has stopped changing for debounceInterval() msec.
+ * a search refining the previous one only checks the previous matches (see QJsonTreeWidget::searchIncremental())
+ *
+ */
+class QJsonTreeSearchSession : public QObject
+{
+  Q_OBJECT
+public:
+  /**
+   * @brief constructor
+   *
+   * @param tree the QJsonTreeWidget to search
+   * @param parent the parent object (optional)
+   */
+  explicit QJsonTreeSearchSession(QJsonTreeWidget* tree, QObject* parent = 0);
+
+  /**
+   * @brief sets the time the text must stay unchanged before searching (default is 250 msec, 0 searches at the next event loop iteration)
+   *
+   * @param msec the interval in msec
+   */
+  void setDebounceInterval(int msec) { m_timer.setInterval(msec); }
+
+  /**
+   * @brief returns the debounce interval
+   *
+   * @return int
+   */
+  int debounceInterval() const { return m_timer.interval(); }
+
+  /**
+   * @brief returns whether a search is scheduled and has not run yet
+   *
+   * @return bool
+   */
+  bool isPending() const { return m_timer.isActive(); }
+
+  /**
+   * @brief returns the text of the last search run
+   *
+   * @return QString
+   */
+  QString text() const { return m_text; }
+
+public slots:
+  /**
+   * @brief schedules a search for text, superseding the scheduled one if any. an empty text cancels the scheduled search and clears the last one (see QJsonTreeWidget::clearSearch())
+   *
+   * @param text the text to find
+   */
+  void setText(const QString& text);
+
+  /**
+   * @brief runs the scheduled search now (i.e. on return pressed)
+   *
+   */
+  void searchNow();
+
+  /**
+   * @brief drops the scheduled search, if any
+   *
+   */
+  void cancel();
+
+signals:
+  /**
+   * @brief emitted when a search has run
+   *
+   * @param text the text searched
+   * @param count the number of matches
+   */
+  void searchFinished(const QString& text, int count);
+
+  /**
+   * @brief emitted when a scheduled search is dropped
+   *
+   */
+  void canceled();
+
+private:
+  QJsonTreeWidget* m_tree;
+  QTimer m_timer;
+  QString m_pendingText;
+  QString m_text;
+};
+
+#endif // QJSONTREESEARCHSESSION_H
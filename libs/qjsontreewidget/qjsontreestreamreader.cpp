@@ -0,0 +1,517 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qjsontreestreamreader.h"
+#include "qjsontreewidget.h"
+
+#define JSON_STREAM_CHUNK_SIZE (64 * 1024) // bytes read from the device at once
+
+QJsonTreeStreamReader::QJsonTreeStreamReader(QJsonTreeWidget *tree)
+{
+  m_tree = tree;
+  m_dev = 0;
+  m_blob = 0;
+  m_pos = 0;
+  m_line = 1;
+  m_bytesRead = 0;
+  m_itemCount = 0;
+  m_errorLine = 0;
+}
+
+QJsonTreeStreamReader::~QJsonTreeStreamReader()
+{
+  delete m_blob;
+}
+
+QJsonTreeItem* QJsonTreeStreamReader::read(QIODevice &dev)
+{
+  m_dev = &dev;
+  m_buf.clear();
+  m_pos = 0;
+  m_line = 1;
+  m_bytesRead = 0;
+  m_itemCount = 0;
+  m_errorLine = 0;
+  m_errorString.clear();
+  delete m_blob;
+  m_blob = 0;
+
+  char c;
+  if (!skipWhitespace() || !peek(&c))
+  {
+    setError(QObject::tr("unexpected end of input"));
+    return 0;
+  }
+
+  // the document items are allocated from a new arena, released with the last of them
+  QJsonTreeItem* top = new (new QJsonTreeItemArena()) QJsonTreeItem(m_tree);
+  bool ok;
+  if (c == '{')
+  {
+    ok = parseItem(top,0);
+  }
+  else
+  {
+    // not an object, the result is an empty item (as QVariant::toMap() would give on the whole document)
+    QVariant v;
+    ok = parseValue(&v);
+  }
+
+  // only whitespace may follow the top level value
+  if (ok && skipWhitespace())
+    ok = setError(QObject::tr("unexpected data after the top level value"));
+
+  if (!ok)
+  {
+    delete top;
+    delete m_blob;
+    m_blob = 0;
+    return 0;
+  }
+  return top;
+}
+
+bool QJsonTreeStreamReader::fill()
+{
+  if (!m_dev)
+    return false;
+
+  // the previous chunk has been fully consumed here
+  QByteArray chunk = m_dev->read(JSON_STREAM_CHUNK_SIZE);
+  while (chunk.isEmpty() && m_dev->isSequential() && m_dev->waitForReadyRead(-1))
+  {
+    chunk = m_dev->read(JSON_STREAM_CHUNK_SIZE);
+  }
+  if (chunk.isEmpty())
+    return false;
+
+  m_buf = chunk;
+  m_pos = 0;
+  m_bytesRead += chunk.size();
+  if (!chunkRead(m_bytesRead,m_itemCount))
+  {
+    // stop here, as if the input was truncated
+    m_buf.clear();
+    m_dev = 0;
+    return setError(QObject::tr("reading aborted"));
+  }
+  return true;
+}
+
+bool QJsonTreeStreamReader::peek(char *c)
+{
+  if (m_pos >= m_buf.size() && !fill())
+    return false;
+  *c = m_buf.at(m_pos);
+  return true;
+}
+
+bool QJsonTreeStreamReader::next(char *c)
+{
+  if (!peek(c))
+    return false;
+  m_pos++;
+  if (*c == '\n')
+    m_line++;
+  return true;
+}
+
+bool QJsonTreeStreamReader::skipWhitespace()
+{
+  char c;
+  while (peek(&c))
+  {
+    if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+      return true;
+    next(&c);
+  }
+  return false;
+}
+
+bool QJsonTreeStreamReader::expect(char c)
+{
+  char n;
+  if (!skipWhitespace() || !next(&n))
+    return setError(QObject::tr("unexpected end of input, expected '%1'").arg(c));
+  if (n != c)
+    return setError(QObject::tr("syntax error, expected '%1', found '%2'").arg(c).arg(n));
+  return true;
+}
+
+bool QJsonTreeStreamReader::setError(const QString &error)
+{
+  // keep the first (innermost) error only
+  if (m_errorString.isEmpty())
+  {
+    m_errorString = error;
+    m_errorLine = m_line;
+  }
+  return false;
+}
+
+bool QJsonTreeStreamReader::parseValue(QVariant *v)
+{
+  char c;
+  if (!skipWhitespace() || !peek(&c))
+    return setError(QObject::tr("unexpected end of input, expected a value"));
+
+  switch (c)
+  {
+    case '{':
+    {
+      QVariantMap m;
+      if (!parseObject(&m))
+        return false;
+      *v = m;
+      return true;
+    }
+
+    case '[':
+    {
+      QVariantList l;
+      if (!parseArray(&l))
+        return false;
+      *v = l;
+      return true;
+    }
+
+    case '"':
+    {
+      QString s;
+      if (!parseString(&s))
+        return false;
+      *v = s;
+      return true;
+    }
+
+    case 't':
+      *v = QVariant(true);
+      return parseLiteral("true");
+
+    case 'f':
+      *v = QVariant(false);
+      return parseLiteral("false");
+
+    case 'n':
+      *v = QVariant();
+      return parseLiteral("null");
+
+    default:
+      break;
+  }
+
+  if (c == '-' || (c >= '0' && c <= '9'))
+    return parseNumber(v);
+  return setError(QObject::tr("syntax error, unexpected '%1'").arg(c));
+}
+
+bool QJsonTreeStreamReader::parseString(QString *s)
+{
+  if (!expect('"'))
+    return false;
+
+  s->clear();
+  QByteArray raw;
+  while (true)
+  {
+    if (m_pos >= m_buf.size() && !fill())
+      return setError(QObject::tr("unexpected end of input in string"));
+
+    // copy everything up to the next quote or escape at once
+    const char* d = m_buf.constData();
+    int end = m_buf.size();
+    int i = m_pos;
+    while (i < end && d[i] != '"' && d[i] != '\\')
+    {
+      if (d[i] == '\n')
+        m_line++;
+      i++;
+    }
+    raw.append(d + m_pos, i - m_pos);
+    m_pos = i;
+    if (i == end)
+      continue;
+
+    char c = d[i];
+    m_pos++;
+    if (c == '"')
+      break;
+
+    // escape sequence, flush the utf-8 collected so far
+    s->append(QString::fromUtf8(raw.constData(),raw.size()));
+    raw.clear();
+    if (!next(&c))
+      return setError(QObject::tr("unexpected end of input in string"));
+    switch (c)
+    {
+      case '"':
+      case '\\':
+      case '/':
+        s->append(QLatin1Char(c));
+      break;
+      case 'b':
+        s->append(QLatin1Char('\b'));
+      break;
+      case 'f':
+        s->append(QLatin1Char('\f'));
+      break;
+      case 'n':
+        s->append(QLatin1Char('\n'));
+      break;
+      case 'r':
+        s->append(QLatin1Char('\r'));
+      break;
+      case 't':
+        s->append(QLatin1Char('\t'));
+      break;
+      case 'u':
+      {
+        // surrogate pairs come as two escapes, appending each QChar rebuilds them
+        char hex[5];
+        for (int h = 0; h < 4; h++)
+        {
+          if (!next(&hex[h]))
+            return setError(QObject::tr("unexpected end of input in string"));
+        }
+        hex[4] = '\0';
+        bool ok;
+        ushort u = QByteArray(hex).toUShort(&ok,16);
+        if (!ok)
+          return setError(QObject::tr("invalid unicode escape '\\u%1'").arg(QLatin1String(hex)));
+        s->append(QChar(u));
+      }
+      break;
+
+      default:
+        return setError(QObject::tr("invalid escape sequence '\\%1'").arg(c));
+    }
+  }
+  s->append(QString::fromUtf8(raw.constData(),raw.size()));
+  return true;
+}
+
+bool QJsonTreeStreamReader::parseNumber(QVariant *v)
+{
+  QByteArray n;
+  bool isdouble = false;
+  char c;
+  while (peek(&c))
+  {
+    if ((c >= '0' && c <= '9') || c == '-' || c == '+')
+      n.append(c);
+    else if (c == '.' || c == 'e' || c == 'E')
+    {
+      n.append(c);
+      isdouble = true;
+    }
+    else
+      break;
+    next(&c);
+  }
+
+  bool ok = false;
+  if (!isdouble)
+  {
+    *v = n.toLongLong(&ok);
+    if (!ok)
+      *v = n.toULongLong(&ok);
+  }
+  if (!ok)
+    *v = n.toDouble(&ok);
+  if (!ok)
+    return setError(QObject::tr("invalid number '%1'").arg(QString::fromLatin1(n)));
+  return true;
+}
+
+bool QJsonTreeStreamReader::parseLiteral(const char *literal)
+{
+  char c;
+  for (const char* p = literal; *p; p++)
+  {
+    if (!next(&c) || c != *p)
+      return setError(QObject::tr("syntax error, expected '%1'").arg(QLatin1String(literal)));
+  }
+  return true;
+}
+
+bool QJsonTreeStreamReader::parseArray(QVariantList *l)
+{
+  if (!expect('['))
+    return false;
+
+  char c;
+  if (!skipWhitespace() || !peek(&c))
+    return setError(QObject::tr("unexpected end of input in array"));
+  if (c == ']')
+    return next(&c);
+
+  while (true)
+  {
+    QVariant v;
+    if (!parseValue(&v))
+      return false;
+    l->append(v);
+
+    if (!skipWhitespace() || !next(&c))
+      return setError(QObject::tr("unexpected end of input in array"));
+    if (c == ']')
+      return true;
+    if (c != ',')
+      return setError(QObject::tr("syntax error, expected ',' or ']', found '%1'").arg(c));
+  }
+}
+
+bool QJsonTreeStreamReader::parseObject(QVariantMap *m)
+{
+  if (!expect('{'))
+    return false;
+
+  char c;
+  if (!skipWhitespace() || !peek(&c))
+    return setError(QObject::tr("unexpected end of input in object"));
+  if (c == '}')
+    return next(&c);
+
+  while (true)
+  {
+    QString key;
+    QVariant v;
+    if (!parseString(&key) || !expect(':') || !parseValue(&v))
+      return false;
+    m->insert(key,v);
+
+    if (!skipWhitespace() || !next(&c))
+      return setError(QObject::tr("unexpected end of input in object"));
+    if (c == '}')
+      return true;
+    if (c != ',')
+      return setError(QObject::tr("syntax error, expected ',' or '}', found '%1'").arg(c));
+  }
+}
+
+bool QJsonTreeStreamReader::parseItem(QJsonTreeItem *item, int depth)
+{
+  if (!expect('{'))
+    return false;
+
+  QVariantMap m;
+  char c;
+  if (!skipWhitespace() || !peek(&c))
+    return setError(QObject::tr("unexpected end of input in object"));
+  if (c == '}')
+    next(&c);
+  else
+  {
+    while (true)
+    {
+      QString key;
+      if (!parseString(&key) || !expect(':'))
+        return false;
+      if (!skipWhitespace() || !peek(&c))
+        return setError(QObject::tr("unexpected end of input, expected a value"));
+
+      if (key == "_children_" && c == '[' && m_tree->lazyLoadingEnabled())
+      {
+        // lazy loading, children are kept raw and materialized on demand by QJsonTreeItem::fetchMore()
+        if (!parseArray(&item->m_pendingChildren))
+          return false;
+      }
+      else if (key == "_children_" && c == '[')
+      {
+        // children become items straight away, they're never stored in the map
+        if (!parseChildren(item,depth))
+          return false;
+      }
+      else if (key == "_blob_" && depth == 0 && c == '{')
+      {
+        // embedded tree into another map, build it as a tree too
+        delete m_blob;
+        m_blob = new (item->arena()) QJsonTreeItem(m_tree);
+        if (!parseItem(m_blob,depth + 1))
+          return false;
+        if (m_blob->m_map.isEmpty() && !m_blob->hasChildren())
+        {
+          // empty blob, the top level object is used as usual
+          delete m_blob;
+          m_blob = 0;
+        }
+      }
+      else
+      {
+        QVariant v;
+        if (!parseValue(&v))
+          return false;
+        m.insert(key,v);
+      }
+
+      if (!skipWhitespace() || !next(&c))
+        return setError(QObject::tr("unexpected end of input in object"));
+      if (c == '}')
+        break;
+      if (c != ',')
+        return setError(QObject::tr("syntax error, expected ',' or '}', found '%1'").arg(c));
+    }
+  }
+
+  item->setItemMap(m);
+  m_itemCount++;
+  return true;
+}
+
+bool QJsonTreeStreamReader::parseChildren(QJsonTreeItem *parent, int depth)
+{
+  if (!expect('['))
+    return false;
+
+  char c;
+  if (!skipWhitespace() || !peek(&c))
+    return setError(QObject::tr("unexpected end of input in array"));
+  if (c == ']')
+    return next(&c);
+
+  while (true)
+  {
+    if (!skipWhitespace() || !peek(&c))
+      return setError(QObject::tr("unexpected end of input in array"));
+
+    // append first, so the child is deleted together with its parent on error
+    QJsonTreeItem* child = new (parent->arena()) QJsonTreeItem(m_tree,parent);
+    parent->appendChild(child);
+    if (c == '{')
+    {
+      if (!parseItem(child,depth + 1))
+        return false;
+    }
+    else
+    {
+      // not an object, it becomes an empty item as in QJsonTreeItem::fromMap()
+      QVariant v;
+      if (!parseValue(&v))
+        return false;
+      m_itemCount++;
+    }
+
+    if (!skipWhitespace() || !next(&c))
+      return setError(QObject::tr("unexpected end of input in array"));
+    if (c == ']')
+      return true;
+    if (c != ',')
+      return setError(QObject::tr("syntax error, expected ',' or ']', found '%1'").arg(c));
+  }
+}
@@ -0,0 +1,139 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QJSONTREESTREAMREADER_H
+#define QJSONTREESTREAMREADER_H
+
+#include <QtCore>
+#include "qjsontreeitem.h"
+
+class QJsonTreeWidget;
+
+/**
+ * @brief streaming JSON reader which builds QJsonTreeItem nodes directly while consuming tokens from a QIODevice.
+ * the whole document is never held as a QVariantMap: each JSON object found in a "_children_" list becomes a QJsonTreeItem as soon as it's parsed,
+ * and only the item own tags are kept as QVariant.
+ *
+ */
+class QJsonTreeStreamReader
+{
+public:
+  /**
+   * @brief constructor
+   *
+   * @param tree the QJsonTreeWidget the built items will belong to
+   */
+  explicit QJsonTreeStreamReader(QJsonTreeWidget* tree);
+
+  /**
+   * @brief destructor (deletes the blob item, if it has not been taken)
+   *
+   */
+  virtual ~QJsonTreeStreamReader();
+
+  /**
+   * @brief parses the JSON from the device, building the items tree.
+   * the returned items are detached (they have no root yet), they must be connected to a root item with QJsonTreeItem::attachSubtree()
+   *
+   * @param dev the device to read from (must be open)
+   * @return QJsonTreeItem the item representing the top level JSON object (owned by the caller), or 0 on error
+   */
+  QJsonTreeItem* read(QIODevice& dev);
+
+  /**
+   * @brief returns the item built from the top level "_blob_" object if any (for embedded trees into another map), ownership passes to the caller
+   *
+   * @return QJsonTreeItem
+   */
+  QJsonTreeItem* takeBlobItem() { QJsonTreeItem* b = m_blob; m_blob = 0; return b; }
+
+  /**
+   * @brief returns whether read() failed
+   *
+   * @return bool
+   */
+  bool hasError() const { return !m_errorString.isEmpty(); }
+
+  /**
+   * @brief returns the line at which the parser error occurred
+   *
+   * @return int
+   */
+  int errorLine() const { return m_errorLine; }
+
+  /**
+   * @brief returns the parser error string
+   *
+   * @return QString
+   */
+  QString errorString() const { return m_errorString; }
+
+  /**
+   * @brief returns the number of bytes consumed so far
+   *
+   * @return qint64
+   */
+  qint64 bytesRead() const { return m_bytesRead; }
+
+  /**
+   * @brief returns the number of items built so far
+   *
+   * @return int
+   */
+  int itemCount() const { return m_itemCount; }
+
+protected:
+  /**
+   * @brief called each time a chunk has been read from the device, reimplement to report progress or to abort
+   *
+   * @param bytesRead the number of bytes consumed so far
+   * @param items the number of items built so far
+   * @return bool false to abort reading (read() fails then)
+   */
+  virtual bool chunkRead(qint64 bytesRead, int items) { Q_UNUSED(bytesRead); Q_UNUSED(items); return true; }
+
+private:
+  bool fill();
+  bool peek(char* c);
+  bool next(char* c);
+  bool skipWhitespace();
+  bool expect(char c);
+  bool parseValue(QVariant* v);
+  bool parseString(QString* s);
+  bool parseNumber(QVariant* v);
+  bool parseLiteral(const char* literal);
+  bool parseArray(QVariantList* l);
+  bool parseObject(QVariantMap* m);
+  bool parseItem(QJsonTreeItem* item, int depth);
+  bool parseChildren(QJsonTreeItem* parent, int depth);
+  bool setError(const QString& error);
+
+  QJsonTreeWidget* m_tree;
+  QIODevice* m_dev;
+  QJsonTreeItem* m_blob;
+  QByteArray m_buf;
+  int m_pos;
+  int m_line;
+  qint64 m_bytesRead;
+  int m_itemCount;
+  int m_errorLine;
+  QString m_errorString;
+};
+
+#endif // QJSONTREESTREAMREADER_H
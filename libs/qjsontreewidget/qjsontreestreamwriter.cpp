@@ -0,0 +1,460 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qjsontreestreamwriter.h"
+#include "qjsontreewidget.h"
+
+#define JSON_STREAM_WRITE_CHUNK_SIZE (64 * 1024) // bytes buffered before writing to the device
+
+enum TagSource {
+  TagFromMap = 0,
+  TagFromChildren = 1,
+  TagFromAdditional = 2
+};
+
+QJsonTreeStreamWriter::QJsonTreeStreamWriter(QJsonTreeWidget *tree)
+{
+  m_tree = tree;
+  m_indentMode = QJson::IndentNone;
+  m_purgeDescriptiveTags = false;
+  m_dev = 0;
+  m_bytesWritten = 0;
+}
+
+bool QJsonTreeStreamWriter::write(QIODevice &dev, const QJsonTreeItem *item, const QVariantMap &additional)
+{
+  m_dev = &dev;
+  m_buf.clear();
+  m_buf.reserve(JSON_STREAM_WRITE_CHUNK_SIZE);
+  m_bytesWritten = 0;
+  m_errorString.clear();
+  if (!item)
+    return setError(QObject::tr("nothing to write"));
+
+  // save options are read once, not for each item
+  m_purgeList = m_tree->purgeListOnSave();
+  m_purgeDescriptiveTags = m_tree->purgeDescriptiveTags();
+
+  // a purged top level item is written empty (plus the additional tags), as toMap() would give
+  QMap<QString,int> tags = savedTags(item,additional);
+  if (!writeItem(item,tags,0,false,additional))
+    return false;
+  return flush();
+}
+
+bool QJsonTreeStreamWriter::isPurged(const QVariantMap &map) const
+{
+  // the purge list is usually way shorter than the item map
+  for (QHash<QString,bool>::const_iterator it = m_purgeList.constBegin(); it != m_purgeList.constEnd(); ++it)
+  {
+    if (it.value() && map.contains(it.key()))
+      return true;
+  }
+  return false;
+}
+
+bool QJsonTreeStreamWriter::isTagSaved(const QString &tag) const
+{
+  if (m_purgeList.contains(tag))
+    return false;
+  if (m_purgeDescriptiveTags)
+  {
+    foreach (QString k, QJsonTreeItem::descriptiveTags)
+    {
+      if (tag.startsWith(k,Qt::CaseInsensitive))
+        return false;
+    }
+  }
+  return true;
+}
+
+QMap<QString,int> QJsonTreeStreamWriter::savedTags(const QJsonTreeItem *item, const QVariantMap &additional) const
+{
+  // the written tags, in the (sorted) order QJson::Serializer would write the item map
+  QMap<QString,int> tags;
+  if (!isPurged(item->m_map))
+  {
+    for (QVariantMap::const_iterator it = item->m_map.constBegin(); it != item->m_map.constEnd(); ++it)
+    {
+      if (isTagSaved(it.key()))
+        tags.insert(it.key(),TagFromMap);
+    }
+    if (item->hasChildren())
+      tags.insert("_children_",TagFromChildren);
+  }
+  for (QVariantMap::const_iterator it = additional.constBegin(); it != additional.constEnd(); ++it)
+  {
+    tags.insert(it.key(),TagFromAdditional);
+  }
+  return tags;
+}
+
+bool QJsonTreeStreamWriter::writeItem(const QJsonTreeItem *item, const QMap<QString,int>& tags, int level, bool trimmed, const QVariantMap &additional)
+{
+  writeMapStart(level,trimmed);
+  bool first = true;
+  for (QMap<QString,int>::const_iterator it = tags.constBegin(); it != tags.constEnd(); ++it)
+  {
+    writePair(it.key(),first,level);
+    first = false;
+
+    bool ok;
+    switch (it.value())
+    {
+      case TagFromChildren:
+        ok = writeChildren(item,level + 1);
+      break;
+
+      case TagFromAdditional:
+        ok = writeValue(additional.value(it.key()),level + 1,true);
+      break;
+
+      default:
+        ok = writeValue(item->m_map.value(it.key()),level + 1,true);
+      break;
+    }
+    if (!ok)
+      return false;
+  }
+  writeMapEnd(level);
+
+  if (m_buf.size() >= JSON_STREAM_WRITE_CHUNK_SIZE)
+    return flush();
+  return true;
+}
+
+bool QJsonTreeStreamWriter::writeChildren(const QJsonTreeItem *item, int level)
+{
+  writeListStart();
+  bool first = true;
+  foreach (QJsonTreeItem* child, item->m_children)
+  {
+    // purged items (or items with all their tags stripped) are skipped, as in toMap()
+    QMap<QString,int> tags = savedTags(child);
+    if (tags.isEmpty())
+      continue;
+
+    if (!first)
+      writeListSeparator();
+    first = false;
+    if (!writeItem(child,tags,level + 1,false))
+      return false;
+  }
+
+  // children not materialized yet (lazy loading) are written from their raw map
+  foreach (QVariant v, item->m_pendingChildren)
+  {
+    QVariantMap m = item->rawToMap(v.toMap());
+    if (m.isEmpty())
+      continue;
+
+    if (!first)
+      writeListSeparator();
+    first = false;
+    if (!writeValue(m,level + 1,false))
+      return false;
+  }
+  writeListEnd(level);
+  return true;
+}
+
+bool QJsonTreeStreamWriter::writeValue(const QVariant &v, int level, bool trimmed)
+{
+  const QVariant::Type type = v.type();
+  if (!v.isValid())
+  {
+    m_buf.append("null");
+  }
+  else if (type == QVariant::List || type == QVariant::StringList)
+  {
+    const QVariantList l = v.toList();
+    writeListStart();
+    for (int i=0; i < l.count(); i++)
+    {
+      if (i > 0)
+        writeListSeparator();
+      if (!writeValue(l.at(i),level + 1,false))
+        return false;
+    }
+    writeListEnd(level);
+  }
+  else if (type == QVariant::Map)
+  {
+    const QVariantMap m = v.toMap();
+    writeMapStart(level,trimmed);
+    bool first = true;
+    for (QVariantMap::const_iterator it = m.constBegin(); it != m.constEnd(); ++it)
+    {
+      writePair(it.key(),first,level);
+      first = false;
+      if (!writeValue(it.value(),level + 1,true))
+        return false;
+    }
+    writeMapEnd(level);
+  }
+  else if (type == QVariant::String || type == QVariant::ByteArray)
+  {
+    writeString(v.toString());
+  }
+  else if (type == QVariant::Double)
+  {
+    double d = v.toDouble();
+    if (qIsNaN(d) || qIsInf(d))
+      return setError(QObject::tr("NaN and infinite numbers can't be written"));
+    QByteArray n = QByteArray::number(d,'g',15);
+    if (!n.contains('.') && !n.contains('e'))
+      n.append(".0");
+    m_buf.append(n);
+  }
+  else if (type == QVariant::Bool)
+  {
+    m_buf.append(v.toBool() ? "true" : "false");
+  }
+  else if (type == QVariant::ULongLong || type == QVariant::UInt)
+  {
+    m_buf.append(QByteArray::number(v.toULongLong()));
+  }
+  else if (v.canConvert<qlonglong>())
+  {
+    m_buf.append(QByteArray::number(v.toLongLong()));
+  }
+  else if (v.canConvert<QString>())
+  {
+    writeString(v.toString());
+  }
+  else
+  {
+    return setError(QObject::tr("unsupported value type '%1'").arg(v.typeName()));
+  }
+  return true;
+}
+
+void QJsonTreeStreamWriter::writeMapStart(int level, bool trimmed)
+{
+  // values in a map are trimmed by QJson::Serializer, so they never start with the indentation
+  switch (m_indentMode)
+  {
+    case QJson::IndentMinimum:
+      if (!trimmed)
+        writeIndent(level);
+      m_buf.append("{ ");
+    break;
+
+    case QJson::IndentMedium:
+    case QJson::IndentFull:
+      if (!trimmed)
+        writeIndent(level);
+      m_buf.append("{\n");
+      writeIndent(level + 1);
+    break;
+
+    case QJson::IndentCompact:
+      m_buf.append('{');
+    break;
+
+    default:
+      m_buf.append("{ ");
+    break;
+  }
+}
+
+void QJsonTreeStreamWriter::writePair(const QString &key, bool first, int level)
+{
+  if (!first)
+  {
+    switch (m_indentMode)
+    {
+      case QJson::IndentFull:
+        m_buf.append(",\n");
+        writeIndent(level + 1);
+      break;
+
+      case QJson::IndentCompact:
+        m_buf.append(',');
+      break;
+
+      default:
+        m_buf.append(", ");
+      break;
+    }
+  }
+  writeString(key);
+  m_buf.append(m_indentMode == QJson::IndentCompact ? ":" : " : ");
+}
+
+void QJsonTreeStreamWriter::writeMapEnd(int level)
+{
+  switch (m_indentMode)
+  {
+    case QJson::IndentMedium:
+    case QJson::IndentFull:
+      m_buf.append('\n');
+      writeIndent(level);
+      m_buf.append('}');
+    break;
+
+    case QJson::IndentCompact:
+      m_buf.append('}');
+    break;
+
+    default:
+      m_buf.append(" }");
+    break;
+  }
+}
+
+void QJsonTreeStreamWriter::writeListStart()
+{
+  switch (m_indentMode)
+  {
+    case QJson::IndentMinimum:
+    case QJson::IndentMedium:
+    case QJson::IndentFull:
+      m_buf.append("[\n");
+    break;
+
+    case QJson::IndentCompact:
+      m_buf.append('[');
+    break;
+
+    default:
+      m_buf.append("[ ");
+    break;
+  }
+}
+
+void QJsonTreeStreamWriter::writeListSeparator()
+{
+  switch (m_indentMode)
+  {
+    case QJson::IndentMinimum:
+    case QJson::IndentMedium:
+    case QJson::IndentFull:
+      m_buf.append(",\n");
+    break;
+
+    case QJson::IndentCompact:
+      m_buf.append(',');
+    break;
+
+    default:
+      m_buf.append(", ");
+    break;
+  }
+}
+
+void QJsonTreeStreamWriter::writeListEnd(int level)
+{
+  switch (m_indentMode)
+  {
+    case QJson::IndentMinimum:
+      m_buf.append('\n');
+      writeIndent(level - 1);
+      m_buf.append(']');
+    break;
+
+    case QJson::IndentMedium:
+    case QJson::IndentFull:
+      m_buf.append('\n');
+      writeIndent(level);
+      m_buf.append(']');
+    break;
+
+    case QJson::IndentCompact:
+      m_buf.append(']');
+    break;
+
+    default:
+      m_buf.append(" ]");
+    break;
+  }
+}
+
+void QJsonTreeStreamWriter::writeIndent(int level)
+{
+  // one space per level, as QJson::Serializer does
+  if (level > 0)
+    m_buf.append(QByteArray(level,' '));
+}
+
+void QJsonTreeStreamWriter::writeString(const QString &s)
+{
+  m_buf.append('"');
+  const QChar* c = s.constData();
+  for (int i=0; i < s.size(); i++)
+  {
+    ushort u = c[i].unicode();
+    switch (u)
+    {
+      case '\\':
+        m_buf.append("\\\\");
+      break;
+      case '"':
+        m_buf.append("\\\"");
+      break;
+      case '\b':
+        m_buf.append("\\b");
+      break;
+      case '\f':
+        m_buf.append("\\f");
+      break;
+      case '\n':
+        m_buf.append("\\n");
+      break;
+      case '\r':
+        m_buf.append("\\r");
+      break;
+      case '\t':
+        m_buf.append("\\t");
+      break;
+      default:
+        if (u < 0x20 || u >= 0x80)
+        {
+          // non ascii characters are escaped as \uXXXX
+          m_buf.append("\\u");
+          m_buf.append(QByteArray::number(u,16).rightJustified(4,'0'));
+        }
+        else
+        {
+          m_buf.append(char(u));
+        }
+      break;
+    }
+  }
+  m_buf.append('"');
+}
+
+bool QJsonTreeStreamWriter::flush()
+{
+  if (m_buf.isEmpty())
+    return true;
+
+  qint64 sz = m_dev->write(m_buf);
+  if (sz != m_buf.size())
+    return setError(QObject::tr("error writing, requested %1, written %2, QIODevice error: %3").arg(m_buf.size()).arg(sz).arg(m_dev->errorString()));
+  m_bytesWritten += sz;
+  m_buf.clear();
+  return true;
+}
+
+bool QJsonTreeStreamWriter::setError(const QString &error)
+{
+  m_errorString = error;
+  return false;
+}
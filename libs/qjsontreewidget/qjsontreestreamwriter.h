@@ -0,0 +1,118 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QJSONTREESTREAMWRITER_H
+#define QJSONTREESTREAMWRITER_H
+
+#include <QtCore>
+#include <QJson/Serializer>
+#include "qjsontreeitem.h"
+
+class QJsonTreeWidget;
+
+/**
+ * @brief streaming JSON writer which walks the QJsonTreeItem children and writes the JSON tokens straight to a QIODevice, in buffered chunks.
+ * the output is the same QJson::Serializer gives on QJsonTreeItem::toMap(), honoring the widget purge list and descriptive tags stripping,
+ * but the tree map is never built.
+ *
+ */
+class QJsonTreeStreamWriter
+{
+public:
+  /**
+   * @brief constructor
+   *
+   * @param tree the QJsonTreeWidget whose save options (purge list, descriptive tags) are applied
+   */
+  explicit QJsonTreeStreamWriter(QJsonTreeWidget* tree);
+
+  /**
+   * @brief sets the indentation mode
+   *
+   * @param mode one of the indentation mode defined in QJson::IndentMode (default is QJson::IndentNone)
+   */
+  void setIndentMode(QJson::IndentMode mode) { m_indentMode = mode; }
+
+  /**
+   * @brief returns the indentation mode
+   *
+   * @return QJson::IndentMode
+   */
+  QJson::IndentMode indentMode() const { return m_indentMode; }
+
+  /**
+   * @brief writes item and its subtree as a JSON object
+   *
+   * @param dev the device to write to (must be open)
+   * @param item the item to write
+   * @param additional an optional additional map, whose tags are added to (or replace) the item ones at top level
+   * @return bool
+   */
+  bool write(QIODevice& dev, const QJsonTreeItem* item, const QVariantMap& additional = QVariantMap());
+
+  /**
+   * @brief returns whether write() failed
+   *
+   * @return bool
+   */
+  bool hasError() const { return !m_errorString.isEmpty(); }
+
+  /**
+   * @brief returns the error string
+   *
+   * @return QString
+   */
+  QString errorString() const { return m_errorString; }
+
+  /**
+   * @brief returns the number of bytes written so far
+   *
+   * @return qint64
+   */
+  qint64 bytesWritten() const { return m_bytesWritten; }
+
+private:
+  bool isPurged(const QVariantMap& map) const;
+  bool isTagSaved(const QString& tag) const;
+  QMap<QString,int> savedTags(const QJsonTreeItem* item, const QVariantMap& additional = QVariantMap()) const;
+  bool writeItem(const QJsonTreeItem* item, const QMap<QString,int>& tags, int level, bool trimmed, const QVariantMap& additional = QVariantMap());
+  bool writeChildren(const QJsonTreeItem* item, int level);
+  bool writeValue(const QVariant& v, int level, bool trimmed);
+  void writeMapStart(int level, bool trimmed);
+  void writePair(const QString& key, bool first, int level);
+  void writeMapEnd(int level);
+  void writeListStart();
+  void writeListSeparator();
+  void writeListEnd(int level);
+  void writeIndent(int level);
+  void writeString(const QString& s);
+  bool flush();
+  bool setError(const QString& error);
+
+  QJsonTreeWidget* m_tree;
+  QJson::IndentMode m_indentMode;
+  QHash<QString,bool> m_purgeList;
+  bool m_purgeDescriptiveTags;
+  QIODevice* m_dev;
+  QByteArray m_buf;
+  qint64 m_bytesWritten;
+  QString m_errorString;
+};
+
+#endif // QJSONTREESTREAMWRITER_H
@@ -0,0 +1,37 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qjsontreevaluedomain.h"
+
+QJsonTreeValueDomain::QJsonTreeValueDomain(const QString &list)
+{
+  QStringList l = list.split(",");
+  m_rows.reserve(l.count());
+  for (int i=l.count() - 1; i >= 0; i--)
+  {
+    // walking backwards, the first occurrence of a repeated value wins
+    m_rows.insert(l.at(i),i);
+  }
+  m_model = new QStringListModel(l);
+}
+
+QJsonTreeValueDomain::~QJsonTreeValueDomain()
+{
+  delete m_model;
+}
@@ -0,0 +1,85 @@
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QJSONTREEVALUEDOMAIN_H
+#define QJSONTREEVALUEDOMAIN_H
+
+#include <QtCore>
+#include <QStringListModel>
+
+#define JSON_TREE_VALUE_DOMAIN_COMPLETION 100 // domains with more values get an editable combo box with completion
+
+/**
+ * @brief the values of a "_valuelist_" string, parsed once and shared by all the combo box editors showing it (see QJsonTreeItemDelegate)
+ *
+ */
+class QJsonTreeValueDomain
+{
+public:
+  /**
+   * @brief constructor, splits the comma separated list
+   *
+   * @param list the "_valuelist_" string
+   */
+  explicit QJsonTreeValueDomain(const QString& list);
+
+  /**
+   * @brief destructor, deletes the model
+   *
+   */
+  ~QJsonTreeValueDomain();
+
+  /**
+   * @brief returns the model holding the values, in list order
+   *
+   * @return QStringListModel
+   */
+  QStringListModel* model() const { return m_model; }
+
+  /**
+   * @brief returns the number of values
+   *
+   * @return int
+   */
+  int count() const { return m_model->rowCount(); }
+
+  /**
+   * @brief returns the row of value (the first one, if repeated)
+   *
+   * @param value the value to find
+   * @return int -1 if not found
+   */
+  int indexOf(const QString& value) const { return m_rows.value(value,-1); }
+
+  /**
+   * @brief returns whether the domain is large enough to be edited with completion
+   *
+   * @return bool
+   */
+  bool needsCompletion() const { return (count() > JSON_TREE_VALUE_DOMAIN_COMPLETION); }
+
+private:
+  Q_DISABLE_COPY(QJsonTreeValueDomain)
+  QStringListModel* m_model;
+  QHash<QString,int> m_rows;
+};
+
+Q_DECLARE_METATYPE(QSharedPointer<QJsonTreeValueDomain>)
+
+#endif // QJSONTREEVALUEDOMAIN_H
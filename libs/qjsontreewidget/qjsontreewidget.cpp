@@ -1,616 +1,1099 @@
-/*
-    This file is part of QJsonTreeWidget.
-
-    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
-
-    QJsonTreeWidget is free software: you can redistribute it and/or modify
-    it under the terms of the GNU General Public License as published by
-    the Free Software Foundation, either version 3 of the License, or
-    (at your option) any later version.
-
-    QJsonTreeWidget is distributed in the hope that it will be useful,
-    but WITHOUT ANY WARRANTY; without even the implied warranty of
-    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-    GNU General Public License for more details.
-
-    You should have received a copy of the GNU General Public License
-    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
- */
-
-#include "qjsontreewidget.h"
-
-QJsonTreeWidget::QJsonTreeWidget(QWidget *parent, Qt::WindowFlags f) :
-  QWidget(parent,f)
-{
-  m_maxVersion = JSON_TREE_MAX_VERSION;
-  m_currentSelection = QModelIndex();
-  m_editing = true;
-  m_purgeDescriptiveTags = false;
-  m_root = 0;
-
-  // create qjson objects
-  m_parser = new QJson::Parser();
-  m_serializer = new QJson::Serializer();
-  m_serializer->setIndentMode(QJson::IndentNone);
-
-  // create the view and organize this widget in a vertical layout
-  QBoxLayout* l= new QVBoxLayout(this);
-  m_view = new QTreeView(this);
-  m_view->setHeaderHidden(false);
-  m_view->setSortingEnabled(false);
-  l->addWidget(m_view);
-
-  // add an optional layout for the user to put its controls in
-  m_optLayout = new QGridLayout(this);
-  l->addLayout(m_optLayout);
-
-  // set the delegate on the view
-  m_delegate = new QJsonTreeItemDelegate(this);
-  m_view->setItemDelegate(m_delegate);
-
-  // add actions reachable by rightclicking on header
-  m_view->setSelectionBehavior(QAbstractItemView::SelectItems);
-  m_actionEnableSort = new QAction(tr("Enable sorting"),m_view);
-  m_actionDisableSort = new QAction(tr("Disable sorting"),m_view);
-  m_actionLoad = new QAction(tr("Load from JSON file"),m_view);
-  m_actionSave = new QAction(tr("Save to JSON file"),m_view);
-  m_actionSaveHtml = new QAction(tr("Save to HTML file"),m_view);
-  m_actionEnableSort->setData("sortenable");
-  m_actionDisableSort->setData("sortdisable");
-  m_actionLoad->setData("load");
-  m_actionSave->setData("save");
-  m_actionSaveHtml->setData("savehtml");
-  connect (m_actionLoad,SIGNAL(triggered()),this,SLOT(onActionLoad()));
-  connect (m_actionSave,SIGNAL(triggered()),this,SLOT(onActionSave()));
-  connect (m_actionSaveHtml,SIGNAL(triggered()),this,SLOT(onActionSaveHtml()));
-  connect (m_actionEnableSort,SIGNAL(triggered()),this,SLOT(onActionEnableSort()));
-  connect (m_actionDisableSort,SIGNAL(triggered()),this,SLOT(onActionDisableSort()));
-  m_actionLoad->setVisible(false);
-  m_actionDisableSort->setVisible(false);
-  m_view->header()->addActions(QList<QAction*>() << m_actionEnableSort << m_actionDisableSort << m_actionLoad << m_actionSave << m_actionSaveHtml);
-  m_view->header()->setContextMenuPolicy(Qt::ActionsContextMenu);
-
-  // for mouseclicks
-  connect (m_delegate,SIGNAL(clicked(const QJsonTreeItem*,QString)),this,SIGNAL(clicked(const QJsonTreeItem*,QString)));
-  connect (m_delegate,SIGNAL(clicked(int,int,QString,QVariant,const QJsonTreeItem*)),this,SIGNAL(clicked(int,int,QString,QVariant,const QJsonTreeItem*)));
-
-  // various options
-  this->setContextMenuPolicy(Qt::CustomContextMenu);
-
-  // create the model and proxy
-  m_model = new QJsonTreeModel(this);
-  connect (m_model,SIGNAL(dataChanged(QModelIndex,QModelIndex)),this,SLOT(onDataChanged(QModelIndex,QModelIndex)));
-  m_proxyModel = new QJsonSortFilterProxyModel(this);
-  m_proxyModel->setDynamicSortFilter(true);
-  m_view->setModel(m_proxyModel);
-}
-
-QJsonTreeWidget::~QJsonTreeWidget()
-{
-  this->clear();
-}
-
-bool QJsonTreeWidget::loadJson(const QString &path)
-{
-  QFile file(path);
-  file.open(QIODevice::ReadOnly);
-  bool b = loadJson(file);
-  file.close();
-  return b;
-}
-
-bool QJsonTreeWidget::loadJson(QIODevice &dev)
-{
-  return loadJson(dev.readAll());
-}
-
-bool QJsonTreeWidget::loadJson(const QByteArray &buf)
-{
-  if (buf.isEmpty())
-  {
-    setNotFoundInvalidOrEmptyError("loadJson","buf");
-    return false;
-  }
-
-  // parse
-  bool ok;
-  QVariantMap map = m_parser->parse(buf,&ok).toMap();
-  if (!ok)
-  {
-      m_error = tr("loadJson: JSON parser error: line %1, %2").arg(QVariant(m_parser->errorLine()).toString()).arg(m_parser->errorString());
-      return false;
-  }
-
-  return loadJson(map);
-}
-
-bool QJsonTreeWidget::loadJson(const QVariantMap &map)
-{
-    return loadJsonInternal(map);
-}
-
-bool QJsonTreeWidget::saveJson(const QString &path, QJson::IndentMode indentmode, const QVariantMap& additional)
-{
-  QFile file(path);
-  bool b = file.open(QIODevice::WriteOnly);
-  b = saveJson(file,indentmode,additional);
-  file.close();
-  return b;
-}
-
-bool QJsonTreeWidget::saveJson(QIODevice &dev, QJson::IndentMode indentmode, const QVariantMap& additional)
-{
-  QByteArray buf = saveJson(indentmode,additional);
-  if (buf.isEmpty())
-  {
-    setNotFoundInvalidOrEmptyError("saveJson","buf");
-    return false;
-  }
-  qint64 sz = dev.write(buf);
-  if (sz != buf.size())
-  {
-    m_error = tr("saveJson: error writing, requested %1, written %2, QIODevice error: %3").arg(QVariant(buf.size()).toString()).arg(QVariant(sz).toString()).arg(dev.errorString());
-    return false;
-  }
-  return true;
-}
-
-QByteArray QJsonTreeWidget::saveJson(QJson::IndentMode indentmode, const QVariantMap& additional)
-{
-  m_serializer->setIndentMode(indentmode);
-  QVariantMap m = m_root->child(0)->toMap();
-  foreach (QString key, additional.keys())
-  {
-      m[key]=additional[key];
-  }
-
-  return m_serializer->serialize(m);
-}
-
-int QJsonTreeWidget::jsonVersion(const QVariantMap map) const
-{
-    int v = map.value("version",-1).toInt();
-    if (v == -1)
-        return -1;
-
-    return v;
-}
-
-void QJsonTreeWidget::resizeColumnsToContents()
-{
-  for (int i=0; i < this->invisibleRootItem()->columnCount(); i++)
-  {
-    resizeColumnToContent(i);
-  }
-}
-
-void QJsonTreeWidget::clear()
-{
-  m_purgeList.clear();
-  m_purgeDescriptiveTags = false;
-  m_model->clear();
-}
-
-void QJsonTreeWidget::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
-{
-  Q_UNUSED(bottomRight);
-  // since we emit onDataChanged with (index,index), topLeft is enough
-  m_view->update(topLeft);
-}
-
-void QJsonTreeWidget::nextSelection()
-{
-  QModelIndexList l = m_view->selectionModel()->selectedIndexes();
-  if (m_currentSelection.isValid())
-  {
-    // get the next
-    int idx = l.lastIndexOf(m_currentSelection);
-    idx++;
-    if (idx > (l.count() - 1))
-    {
-      m_currentSelection = l.first();
-    }
-    else
-    {
-      m_currentSelection = l.at(idx);
-    }
-
-    // scroll to the current selection
-    m_view->scrollTo(m_currentSelection);
-  }
-  else
-  {
-    m_currentSelection = l.first();
-
-    // scroll to the current selection
-    m_view->scrollTo(m_currentSelection);
-  }
-}
-
-void QJsonTreeWidget::setNotFoundInvalidOrEmptyError(const QString &function, const QString &val)
-{
-  m_error=tr("%1: ERROR not found, empty or invalid:\n%2").arg(function).arg(val);
-}
-
-void QJsonTreeWidget::keyPressEvent(QKeyEvent *event)
-{
-  if (event->key() == Qt::Key_F3)
-    nextSelection();
-  else if (event->key() == Qt::Key_C && event->modifiers() & Qt::ControlModifier)
-  {
-    // copy to clipboard requested
-    QModelIndex idx = m_proxyModel->mapToSource(m_view->selectionModel()->selectedIndexes().at(0));
-    if (idx.isValid())
-    {
-      QJsonTreeItem* it = m_model->itemByModelIndex(idx);
-      if (it)
-        QApplication::clipboard()->setText(it->text(idx.column()));
-    }
-  }
-}
-
-bool QJsonTreeWidget::loadJsonInternal(const QVariantMap& map)
-{
-  this->clear();
-
-  if (map.isEmpty())
-  {
-      setNotFoundInvalidOrEmptyError("loadJsonInternal","map");
-      return false;
-  }
-
-  int v = jsonVersion(map);
-  if (v == -1)
-  {
-    setNotFoundInvalidOrEmptyError("loadJsonInternal","_version_");
-    return false;
-  }
-  if (v > m_maxVersion)
-  {
-    m_error = tr("loadJsonInternal: Unsupported JSON version: %1, maxversion: %2").arg(v).arg(m_maxVersion);
-    return false;
-  }
-
-  QVariantMap maptouse = map;
-  QVariantMap blob = map.value("_blob_",QVariantMap()).toMap();
-  if (!blob.isEmpty())
-  {
-      // we use blob instead (for embedded trees into another map)
-      maptouse = blob;
-  }
-
-  // create the root item. the root item is invisible, we use it only to store the headers hash.
-  // so we need only _headers_ in it
-  QString hdrstring = maptouse.value("_headers_",QString()).toString();
-  if (hdrstring.isEmpty())
-  {
-    setNotFoundInvalidOrEmptyError("loadJsonInternal","_headers_");
-    return false;
-  }
-
-  QVariantMap m;
-  m["_headers_"]=hdrstring;
-  m_root = new QJsonTreeItem(this,0,m);
-  if (!m_root->isValid())
-  {
-    // something wrong with the invisible root item (probably header)
-    QByteArray invalid = m_serializer->serialize(m_root->invalidMap());
-    setNotFoundInvalidOrEmptyError("buildModel",invalid);
-    this->clear();
-    return false;
-  }
-
-  QJsonTreeItem* r = new QJsonTreeItem(this,m_root,maptouse); // this is the real root, 1st child of invisibleroot
-  if (!m_root->isValid())
-  {
-    // something wrong with the real root item (probably header)
-    QByteArray invalid = m_serializer->serialize(m_root->invalidMap());
-    setNotFoundInvalidOrEmptyError("loadJsonInternal",invalid);
-    this->clear();
-    return false;
-  }
-  m_root->appendChild(r);
-
-  m_model->setRoot(m_root);
-  m_proxyModel->setSourceModel(m_model);
-  return true;
-
-}
-
-void QJsonTreeWidget::setSortingEnabled(bool enable)
-{
-  m_view->setSortingEnabled(enable);
-  if (!enable)
-  {
-    m_actionEnableSort->setVisible(true);
-    m_actionDisableSort->setVisible(false);
-    m_proxyModel->sort(-1);
-  }
-  else
-  {
-    // sorting enabled
-    m_actionEnableSort->setVisible(false);
-    m_actionDisableSort->setVisible(true);
-  }
-}
-
-void QJsonTreeWidget::search(const QString& text)
-{
-  this->expandAll();
-  m_proxyModel->setFilterRegExp(QRegExp(text,Qt::CaseInsensitive,QRegExp::FixedString));
-  searchInternal();
-}
-
-void QJsonTreeWidget::search(const QRegExp& regex)
-{
-  m_proxyModel->setFilterRegExp(regex);
-  searchInternal();
-}
-
-void QJsonTreeWidget::searchInternal()
-{
-  m_view->selectionModel()->select(QModelIndex(),QItemSelectionModel::Clear);
-  m_proxyModel->setFilterKeyColumn(-1);
-  this->setFocus();
-  this->nextSelection();
-}
-
-void QJsonTreeWidget::onActionLoad()
-{
-  QString fname = QFileDialog::getOpenFileName(this, tr("Load JSON"),QString(),tr("JSON Files (*.json)"));
-  if (!fname.isEmpty())
-  {
-    loadJson(fname);
-    this->expandAll();
-    this->resizeColumnToContent(0);
-  }
-}
-
-void QJsonTreeWidget::onActionSave()
-{
-  QString fname = QFileDialog::getSaveFileName(this, tr("Save JSON"),QString(),tr("JSON Files (*.json)"));
-  if (!fname.isEmpty())
-  {
-    saveJson(fname,QJson::IndentMinimum);
-  }
-}
-
-void QJsonTreeWidget::onActionSaveHtml()
-{
-  QString fname = QFileDialog::getSaveFileName(this, tr("Save HTML"),QString(),tr("HTML Files (*.html)"));
-  if (!fname.isEmpty())
-  {
-    toHtmlFile(fname);
-  }
-}
-
-void QJsonTreeWidget::onActionEnableSort()
-{
-  setSortingEnabled(true);
-}
-
-void QJsonTreeWidget::onActionDisableSort()
-{
-  setSortingEnabled(false);
-}
-
-bool QJsonTreeWidget::validateItems(const QJsonTreeItem* item) const
-{
-  // whole tree ?
-  if (item == 0)
-  {
-    item = m_root;
-  }
-
-  QString failname;
-  QString failcol;
-  QString failval;
-  if (!item->validateRegexp(&failcol,&failname,&failval))
-  {
-    QMessageBox::warning(0,tr("Invalid input"), tr("Name: ") % failname % "\n" % tr("Column: ") % failcol % "\n" % tr("Text: ") % failval);
-    return false;
-  }
-  if (item->childCount() > 0)
-  {
-    foreach (QJsonTreeItem* it, item->children())
-    {
-      // recurse
-      if (!validateItems(it))
-        return false;
-    }
-  }
-  return true;
-}
-
-bool QJsonTreeWidget::findTag(const QString& tag, const QJsonTreeItem* item, QJsonTreeItem** found) const
-{
-  if (item == 0)
-  {
-    item = m_root;
-  }
-
-  if (item->map().contains(tag))
-  {
-    if (found)
-    {
-      *found = const_cast<QJsonTreeItem*>(item);
-    }
-    return true;
-  }
-
-  if (item->childCount() > 0)
-  {
-    foreach (QJsonTreeItem* it, item->children())
-    {
-      // recurse
-      if (findTag(tag,it,found))
-        return true;
-    }
-  }
-  return false;
-}
-
-void QJsonTreeWidget::toHtmlEnd(QXmlStreamWriter* str, const QHash<QString, QString> div) const
-{
-  // close html
-  str->writeEndElement(); // table
-  if (!div.isEmpty())
-  {
-    str->writeEndElement(); // div
-  }
-  str->writeEndElement(); // body
-  str->writeEndElement(); // html
-  delete str;
-}
-
-QXmlStreamWriter* QJsonTreeWidget::toHtmlStart(QString *dest, const QString &title, const QHash<QString, QString> div, const QModelIndex& index) const
-{
-  QXmlStreamWriter* str;
-  str = new QXmlStreamWriter(dest);
-  str->setAutoFormatting(true);
-
-  // html header
-  str->writeStartElement("html");
-  str->writeStartElement("head");
-  if (!title.isEmpty())
-  {
-    str->writeTextElement("title",title);
-  }
-  str->writeEndElement(); // head
-
-  // body
-  str->writeStartElement("body");
-  if (!div.isEmpty())
-  {
-    // div
-    str->writeStartElement("div");
-    foreach (QString k, div.keys())
-    {
-      str->writeAttribute(k,div[k]);
-    }
-  }
-
-  // table
-  str->writeStartElement("table");
-  str->writeAttribute("border","1");
-  str->writeStartElement("tr");
-  QJsonTreeItem* item = m_model->itemByModelIndex(QJsonSortFilterProxyModel::indexToSourceIndex(index));
-  for (int i=0; i < item->columnCount(); i++)
-  {
-    // headers
-    str->writeTextElement("th",item->headerNameByIdx(i));
-  }
-  str->writeEndElement(); // tr
-
-  return str;
-}
-
-void QJsonTreeWidget::toHtmlInternal(QXmlStreamWriter *str, const QModelIndex &index) const
-{
-  QJsonTreeItem* item = m_model->itemByModelIndex(QJsonSortFilterProxyModel::indexToSourceIndex(index));
-
-  // depth spaces
-  int depth = item->depth();
-  QString spaces;
-  for (int i=1; i < depth; i++)
-  {
-    spaces.append(" ");
-  }
-
-  str->writeStartElement("tr");
-  for (int i=0; i < item->columnCount(); i++)
-  {
-    QString s = item->map().value(item->headerTagByIdx(i),QString()).toString();
-
-    str->writeStartElement("td");
-    if (item->hasChildren())
-    {
-      str->writeStartElement("b"); // parent bold
-    }
-
-    if (i == 0)
-    {
-      // column 0 has spacing
-      if (!spaces.isEmpty())
-      {
-        str->writeStartElement("pre");
-        str->writeCharacters(spaces);
-      }
-    }
-    str->writeCharacters(s);
-    if (!spaces.isEmpty() && i == 0)
-    {
-      str->writeEndElement(); // pre
-    }
-    if (item->hasChildren())
-    {
-      str->writeEndElement(); // b
-    }
-    str->writeEndElement(); // td
-
-  }
-  str->writeEndElement(); // tr
-
-  // recurse
-  int i = 0;
-  while (true)
-  {
-    QModelIndex idx = index.child(i,0);
-    if (!idx.isValid())
-      break;
-    toHtmlInternal(str,idx);
-    i++;
-  }
-}
-
-bool QJsonTreeWidget::toHtmlFile(const QString &path, const QString &title, const QHash<QString,QString> div, QJsonTreeItem *item) const
-{
-  QFile f (path);
-  if (!f.open(QIODevice::WriteOnly))
-    return false;
-
-  QString s = toHtml(title,div,item);
-  if (s.isEmpty())
-  {
-    f.close();
-    return false;
-  }
-  f.write(s.toLatin1());
-  f.close();
-  return true;
-}
-
-void QJsonTreeWidget::setHeaderMenuEnabled(bool enable)
-{
-  if (enable)
-  {
-    m_view->header()->setContextMenuPolicy(Qt::ActionsContextMenu);
-  }
-  else
-  {
-    m_view->header()->setContextMenuPolicy(Qt::NoContextMenu);
-  }
-}
-
-QString QJsonTreeWidget::toHtml(const QString &title, const QHash<QString,QString> div, QJsonTreeItem *item) const
-{
-  QModelIndex idx;
-
-  if (!item)
-  {
-    // get the view's root
-    idx = m_proxyModel->index(0,0,QModelIndex());
-  }
-  else
-  {
-    // specific item
-    idx = QJsonSortFilterProxyModel::indexToProxyIndex(m_model->indexByItem(item,0));
-  }
-
-  QString s;
-  QXmlStreamWriter* str = toHtmlStart(&s,title,div,idx);
-  toHtmlInternal(str,idx);
-
-  toHtmlEnd(str,div);
-  return s;
-}
+/*
+    This file is part of QJsonTreeWidget.
+
+    Copyright (C) 2012 valerino <valerio.lupi@te4i.com>
+
+    QJsonTreeWidget is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QJsonTreeWidget is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QJsonTreeWidget.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qjsontreewidget.h"
+
+QJsonTreeWidget::QJsonTreeWidget(QWidget *parent, Qt::WindowFlags f) :
+  QWidget(parent,f)
+{
+  m_maxVersion = JSON_TREE_MAX_VERSION;
+  m_currentSelection = QModelIndex();
+  m_editing = true;
+  m_purgeDescriptiveTags = false;
+  m_lazyLoading = false;
+  m_expandMatchesOnly = false;
+  m_expansionSaved = false;
+  m_root = 0;
+  m_loader = 0;
+
+  // items may be built by a loader thread, initialize their shared tables here
+  QJsonTreeItem::buildStaticTables();
+
+  // create qjson objects
+  m_parser = new QJson::Parser();
+  m_serializer = new QJson::Serializer();
+  m_serializer->setIndentMode(QJson::IndentNone);
+
+  // create the view and organize this widget in a vertical layout
+  QBoxLayout* l= new QVBoxLayout(this);
+  m_view = new QTreeView(this);
+  m_view->setHeaderHidden(false);
+  m_view->setSortingEnabled(false);
+  l->addWidget(m_view);
+
+  // add an optional layout for the user to put its controls in
+  m_optLayout = new QGridLayout(this);
+  l->addLayout(m_optLayout);
+
+  // set the delegate on the view
+  m_delegate = new QJsonTreeItemDelegate(this);
+  m_view->setItemDelegate(m_delegate);
+
+  // add actions reachable by rightclicking on header
+  m_view->setSelectionBehavior(QAbstractItemView::SelectItems);
+  m_actionEnableSort = new QAction(tr("Enable sorting"),m_view);
+  m_actionDisableSort = new QAction(tr("Disable sorting"),m_view);
+  m_actionLoad = new QAction(tr("Load from JSON file"),m_view);
+  m_actionSave = new QAction(tr("Save to JSON file"),m_view);
+  m_actionSaveHtml = new QAction(tr("Save to HTML file"),m_view);
+  m_actionEnableSort->setData("sortenable");
+  m_actionDisableSort->setData("sortdisable");
+  m_actionLoad->setData("load");
+  m_actionSave->setData("save");
+  m_actionSaveHtml->setData("savehtml");
+  connect (m_actionLoad,SIGNAL(triggered()),this,SLOT(onActionLoad()));
+  connect (m_actionSave,SIGNAL(triggered()),this,SLOT(onActionSave()));
+  connect (m_actionSaveHtml,SIGNAL(triggered()),this,SLOT(onActionSaveHtml()));
+  connect (m_actionEnableSort,SIGNAL(triggered()),this,SLOT(onActionEnableSort()));
+  connect (m_actionDisableSort,SIGNAL(triggered()),this,SLOT(onActionDisableSort()));
+  m_actionLoad->setVisible(false);
+  m_actionDisableSort->setVisible(false);
+  m_view->header()->addActions(QList<QAction*>() << m_actionEnableSort << m_actionDisableSort << m_actionLoad << m_actionSave << m_actionSaveHtml);
+  m_view->header()->setContextMenuPolicy(Qt::ActionsContextMenu);
+
+  // for mouseclicks
+  connect (m_delegate,SIGNAL(clicked(const QJsonTreeItem*,QString)),this,SIGNAL(clicked(const QJsonTreeItem*,QString)));
+  connect (m_delegate,SIGNAL(clicked(int,int,QString,QVariant,const QJsonTreeItem*)),this,SIGNAL(clicked(int,int,QString,QVariant,const QJsonTreeItem*)));
+
+  // various options
+  this->setContextMenuPolicy(Qt::CustomContextMenu);
+
+  // create the model and proxy
+  m_model = new QJsonTreeModel(this);
+  connect (m_model,SIGNAL(dataChanged(QModelIndex,QModelIndex)),this,SLOT(onDataChanged(QModelIndex,QModelIndex)));
+  connect (m_model,SIGNAL(rowsInserted(QModelIndex,int,int)),this,SLOT(onRowsInserted()));
+  connect (m_model,SIGNAL(modelReset()),this,SLOT(onModelReset()));
+  m_proxyModel = new QJsonSortFilterProxyModel(this);
+  m_proxyModel->setDynamicSortFilter(true);
+  connect (m_proxyModel,SIGNAL(rowsInserted(QModelIndex,int,int)),this,SLOT(onFilterChanged()));
+  connect (m_proxyModel,SIGNAL(layoutChanged()),this,SLOT(onFilterChanged()));
+  m_view->setModel(m_proxyModel);
+}
+
+QJsonTreeWidget::~QJsonTreeWidget()
+{
+  // stop a running load (the loader deletes its tree)
+  delete m_loader;
+  this->clear();
+}
+
+bool QJsonTreeWidget::loadJson(const QString &path)
+{
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly))
+  {
+    m_error = tr("loadJson: can't open %1: %2").arg(path).arg(file.errorString());
+    return false;
+  }
+  bool b = loadJson(file);
+  file.close();
+  return b;
+}
+
+bool QJsonTreeWidget::loadJson(QIODevice &dev)
+{
+  return loadJson(dev.readAll());
+}
+
+bool QJsonTreeWidget::loadJson(const QByteArray &buf)
+{
+  if (buf.isEmpty())
+  {
+    setNotFoundInvalidOrEmptyError("loadJson","buf");
+    return false;
+  }
+
+  // parse
+  bool ok;
+  QVariantMap map = m_parser->parse(buf,&ok).toMap();
+  if (!ok)
+  {
+      m_error = tr("loadJson: JSON parser error: line %1, %2").arg(QVariant(m_parser->errorLine()).toString()).arg(m_parser->errorString());
+      return false;
+  }
+
+  return loadJson(map);
+}
+
+bool QJsonTreeWidget::loadJson(const QVariantMap &map)
+{
+    return loadJsonInternal(map);
+}
+
+void QJsonTreeWidget::loadJsonAsync(const QString &path)
+{
+  if (m_loader)
+  {
+    // cancel the running load, its tree is discarded
+    disconnect(m_loader,0,this,0);
+    delete m_loader;
+    m_loader = 0;
+    m_error = tr("loadJsonAsync: loading canceled");
+    emit loadJsonFinished(false);
+  }
+
+  m_loader = new QJsonTreeLoader(this,path,this);
+  connect (m_loader,SIGNAL(progress(qint64,qint64,int)),this,SIGNAL(loadJsonProgress(qint64,qint64,int)));
+  connect (m_loader,SIGNAL(finished()),this,SLOT(onLoaderFinished()));
+  m_loader->start();
+}
+
+void QJsonTreeWidget::onLoaderFinished()
+{
+  QJsonTreeLoader* loader = m_loader;
+  m_loader = 0;
+  if (!loader)
+    return;
+
+  QJsonTreeItem* root = loader->takeRoot();
+  if (!root)
+  {
+    // the current tree is left untouched
+    m_error = loader->error();
+    loader->deleteLater();
+    emit loadJsonFinished(false);
+    return;
+  }
+  loader->deleteLater();
+
+  // same as clear(), but the tree is replaced in a single model reset by setRootItem()
+  m_purgeList.clear();
+  m_purgeDescriptiveTags = false;
+  setRootItem(root);
+  emit loadJsonFinished(true);
+}
+
+bool QJsonTreeWidget::saveJson(const QString &path, QJson::IndentMode indentmode, const QVariantMap& additional)
+{
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly))
+  {
+    m_error = tr("saveJson: can't open %1: %2").arg(path).arg(file.errorString());
+    return false;
+  }
+  bool b = saveJson(file,indentmode,additional);
+  file.close();
+  return b;
+}
+
+bool QJsonTreeWidget::saveJson(QIODevice &dev, QJson::IndentMode indentmode, const QVariantMap& additional)
+{
+  if (!m_root || m_root->childCount() == 0)
+  {
+    setNotFoundInvalidOrEmptyError("saveJson","root");
+    return false;
+  }
+
+  // the tree is written straight to the device, without building its map
+  QJsonTreeStreamWriter writer(this);
+  writer.setIndentMode(indentmode);
+  if (!writer.write(dev,m_root->child(0),additional))
+  {
+    m_error = tr("saveJson: %1").arg(writer.errorString());
+    return false;
+  }
+  return true;
+}
+
+QByteArray QJsonTreeWidget::saveJson(QJson::IndentMode indentmode, const QVariantMap& additional)
+{
+  QByteArray buf;
+  QBuffer dev(&buf);
+  dev.open(QIODevice::WriteOnly);
+  if (!saveJson(dev,indentmode,additional))
+    return QByteArray();
+  return buf;
+}
+
+int QJsonTreeWidget::jsonVersion(const QVariantMap map) const
+{
+    int v = map.value("version",-1).toInt();
+    if (v == -1)
+        return -1;
+
+    return v;
+}
+
+void QJsonTreeWidget::resizeColumnsToContents()
+{
+  for (int i=0; i < this->invisibleRootItem()->columnCount(); i++)
+  {
+    resizeColumnToContent(i);
+  }
+}
+
+void QJsonTreeWidget::clear()
+{
+  m_purgeList.clear();
+  m_purgeDescriptiveTags = false;
+  m_model->clear();
+}
+
+void QJsonTreeWidget::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+  // a batch (see beginBatch()) may change a whole range, then the viewport is updated at once
+  if (topLeft == bottomRight)
+    m_view->update(m_proxyModel->mapFromSource(topLeft));
+  else
+    m_view->viewport()->update();
+
+  // the edited item may match now, the last search can't be narrowed anymore
+  m_lastSearchText = QString();
+}
+
+void QJsonTreeWidget::onRowsInserted()
+{
+  // new items may match, the last search can't be narrowed anymore
+  m_lastSearchText = QString();
+}
+
+void QJsonTreeWidget::onFilterChanged()
+{
+  // rows shown by the filter may match, the last search can't be narrowed anymore
+  m_lastSearchText = QString();
+}
+
+void QJsonTreeWidget::onModelReset()
+{
+  m_lastSearchText = QString();
+
+  // the saved expansion state refers to the previous tree
+  m_savedExpansion.clear();
+  m_expansionSaved = false;
+}
+
+void QJsonTreeWidget::nextSelection()
+{
+  showSearchResult(m_searchResults.next());
+}
+
+void QJsonTreeWidget::previousSelection()
+{
+  showSearchResult(m_searchResults.previous());
+}
+
+void QJsonTreeWidget::showSearchResult(const QModelIndex &index)
+{
+  if (!index.isValid())
+    return;
+
+  // scroll to the current selection
+  m_currentSelection = m_proxyModel->mapFromSource(index);
+  if (m_currentSelection.isValid())
+    m_view->scrollTo(m_currentSelection);
+  emit searchPositionChanged(m_searchResults.position(),m_searchResults.count());
+}
+
+void QJsonTreeWidget::setNotFoundInvalidOrEmptyError(const QString &function, const QString &val)
+{
+  m_error=notFoundInvalidOrEmptyError(function,val);
+}
+
+QString QJsonTreeWidget::notFoundInvalidOrEmptyError(const QString &function, const QString &val) const
+{
+  return tr("%1: ERROR not found, empty or invalid:\n%2").arg(function).arg(val);
+}
+
+void QJsonTreeWidget::keyPressEvent(QKeyEvent *event)
+{
+  if (event->key() == Qt::Key_F3 && event->modifiers() & Qt::ShiftModifier)
+    previousSelection();
+  else if (event->key() == Qt::Key_F3)
+    nextSelection();
+  else if (event->key() == Qt::Key_C && event->modifiers() & Qt::ControlModifier)
+  {
+    // copy to clipboard requested
+    QModelIndex idx = m_proxyModel->mapToSource(m_view->selectionModel()->selectedIndexes().at(0));
+    if (idx.isValid())
+    {
+      QJsonTreeItem* it = m_model->itemByModelIndex(idx);
+      if (it)
+        QApplication::clipboard()->setText(it->text(idx.column()));
+    }
+  }
+}
+
+void QJsonTreeWidget::changeEvent(QEvent *event)
+{
+  // the controls rendered by the delegate depend on the style and the palette
+  if (event->type() == QEvent::StyleChange || event->type() == QEvent::PaletteChange)
+    QJsonTreeItemDelegate::styleChanged();
+  QWidget::changeEvent(event);
+}
+
+bool QJsonTreeWidget::loadJsonInternal(const QVariantMap& map)
+{
+  this->clear();
+
+  if (map.isEmpty())
+  {
+      setNotFoundInvalidOrEmptyError("loadJsonInternal","map");
+      return false;
+  }
+
+  if (!checkJsonVersion(map,&m_error))
+    return false;
+
+  QVariantMap maptouse = map;
+  QVariantMap blob = map.value("_blob_",QVariantMap()).toMap();
+  if (!blob.isEmpty())
+  {
+      // we use blob instead (for embedded trees into another map)
+      maptouse = blob;
+  }
+
+  QJsonTreeItem* root = createRootItem(maptouse,"loadJsonInternal",&m_error);
+  if (!root)
+    return false;
+
+  QJsonTreeItem* r = new (root->arena()) QJsonTreeItem(this,root,maptouse); // this is the real root, 1st child of invisibleroot
+  if (!root->isValid())
+  {
+    // something wrong with the real root item (probably header)
+    QByteArray invalid = m_serializer->serialize(root->invalidMap());
+    setNotFoundInvalidOrEmptyError("loadJsonInternal",invalid);
+    delete root;
+    return false;
+  }
+  root->appendChild(r);
+
+  setRootItem(root);
+  return true;
+}
+
+bool QJsonTreeWidget::loadJsonStream(QIODevice &dev)
+{
+  this->clear();
+
+  QJsonTreeStreamReader reader(this);
+  QJsonTreeItem* root = buildTreeFromStream(reader,dev,&m_error);
+  if (!root)
+    return false;
+
+  setRootItem(root);
+  return true;
+}
+
+QJsonTreeItem* QJsonTreeWidget::buildTreeFromStream(QJsonTreeStreamReader &reader, QIODevice &dev, QString *error) const
+{
+  QJsonTreeItem* top = reader.read(dev);
+  if (!top)
+  {
+    if (reader.bytesRead() == 0)
+      *error = notFoundInvalidOrEmptyError("loadJsonStream","dev");
+    else
+      *error = tr("loadJson: JSON parser error: line %1, %2").arg(QVariant(reader.errorLine()).toString()).arg(reader.errorString());
+    return 0;
+  }
+
+  // the same checks done by loadJsonInternal() on the parsed map
+  if (top->map().isEmpty())
+  {
+    *error = notFoundInvalidOrEmptyError("loadJsonInternal","map");
+    delete top;
+    return 0;
+  }
+  if (!checkJsonVersion(top->map(),error))
+  {
+    delete top;
+    return 0;
+  }
+
+  QJsonTreeItem* r = reader.takeBlobItem();
+  if (r)
+  {
+    // we use blob instead (for embedded trees into another map)
+    delete top;
+  }
+  else
+  {
+    r = top;
+  }
+
+  QJsonTreeItem* root = createRootItem(r->map(),"loadJsonInternal",error,r->arena());
+  if (!root)
+  {
+    delete r;
+    return 0;
+  }
+
+  // the real root has been built detached, connect it to the invisible root as 1st child
+  r->attachSubtree(root);
+  root->appendChild(r);
+  return root;
+}
+
+bool QJsonTreeWidget::checkJsonVersion(const QVariantMap &map, QString *error) const
+{
+  int v = jsonVersion(map);
+  if (v == -1)
+  {
+    *error = notFoundInvalidOrEmptyError("loadJsonInternal","_version_");
+    return false;
+  }
+  if (v > m_maxVersion)
+  {
+    *error = tr("loadJsonInternal: Unsupported JSON version: %1, maxversion: %2").arg(v).arg(m_maxVersion);
+    return false;
+  }
+  return true;
+}
+
+QJsonTreeItem* QJsonTreeWidget::createRootItem(const QVariantMap &maptouse, const QString& function, QString *error, QJsonTreeItemArena* arena) const
+{
+  // create the root item. the root item is invisible, we use it only to store the headers hash.
+  // so we need only _headers_ in it
+  QString hdrstring = maptouse.value("_headers_",QString()).toString();
+  if (hdrstring.isEmpty())
+  {
+    *error = notFoundInvalidOrEmptyError(function,"_headers_");
+    return 0;
+  }
+
+  QVariantMap m;
+  m["_headers_"]=hdrstring;
+  // the document items are allocated from a new arena (or the one of the detached items built by QJsonTreeStreamReader), released with the last of them
+  if (!arena)
+    arena = new QJsonTreeItemArena();
+  QJsonTreeItem* root = new (arena) QJsonTreeItem(const_cast<QJsonTreeWidget*>(this),0,m);
+  if (!root->isValid())
+  {
+    // something wrong with the invisible root item (probably header). use a private serializer, this may be called from any thread
+    QJson::Serializer serializer;
+    QByteArray invalid = serializer.serialize(root->invalidMap());
+    *error = notFoundInvalidOrEmptyError("buildModel",invalid);
+    delete root;
+    return 0;
+  }
+  return root;
+}
+
+void QJsonTreeWidget::setRootItem(QJsonTreeItem *root)
+{
+  m_root = root;
+  m_model->setRoot(m_root);
+  m_proxyModel->setSourceModel(m_model);
+}
+
+void QJsonTreeWidget::setSortingEnabled(bool enable)
+{
+  m_view->setSortingEnabled(enable);
+  if (!enable)
+  {
+    m_actionEnableSort->setVisible(true);
+    m_actionDisableSort->setVisible(false);
+    m_proxyModel->sort(-1);
+  }
+  else
+  {
+    // sorting enabled
+    m_actionEnableSort->setVisible(false);
+    m_actionDisableSort->setVisible(true);
+  }
+}
+
+void QJsonTreeWidget::search(const QString& text)
+{
+  // the whole tree must be built to be searched
+  m_model->fetchAll();
+  QModelIndexList matches = m_proxyModel->searchMatches(QRegExp(text,Qt::CaseInsensitive,QRegExp::FixedString));
+  expandForSearch(matches);
+  searchInternal(matches);
+  m_lastSearchText = text;
+}
+
+void QJsonTreeWidget::searchIncremental(const QString& text)
+{
+  if (m_lastSearchText.isEmpty() || !text.contains(m_lastSearchText,Qt::CaseInsensitive))
+  {
+    // the text diverges from the last one, full search
+    m_model->fetchAll();
+    QModelIndexList matches = m_proxyModel->searchMatches(QRegExp(text,Qt::CaseInsensitive,QRegExp::FixedString));
+    expandForSearch(matches);
+    searchInternal(matches,false);
+    m_lastSearchText = text;
+    return;
+  }
+
+  // only the items matched by the last search may contain a text extending it (the matches of an item are adjacent)
+  QVector<QJsonTreeItem*> items;
+  QJsonTreeItem* last = 0;
+  for (int i=0; i < m_searchResults.count(); i++)
+  {
+    QJsonTreeItem* it = m_model->itemByModelIndex(m_searchResults.at(i));
+    if (it && it != last)
+      items.append(it);
+    last = it;
+  }
+  QModelIndexList matches = m_proxyModel->searchMatches(QRegExp(text,Qt::CaseInsensitive,QRegExp::FixedString),items);
+  if (m_expandMatchesOnly)
+    expandForSearch(matches);
+  searchInternal(matches,false);
+  m_lastSearchText = text;
+}
+
+void QJsonTreeWidget::search(const QRegExp& regex)
+{
+  m_model->fetchAll();
+  QModelIndexList matches = m_proxyModel->searchMatches(regex);
+  if (m_expandMatchesOnly)
+    expandForSearch(matches);
+  searchInternal(matches);
+  m_lastSearchText = QString();
+}
+
+void QJsonTreeWidget::beginBatch()
+{
+  m_model->beginBatch();
+}
+
+void QJsonTreeWidget::endBatch()
+{
+  if (!m_model->isBatching())
+    return;
+  if (m_model->batchDepth() > 1 || !m_model->hasBatchChanges() || !m_proxyModel->dynamicSortFilter())
+  {
+    m_model->endBatch();
+    return;
+  }
+
+  // the proxy doesn't sort or filter the emitted ranges one by one: it filters once, then restoring
+  // the dynamic sort sorts once
+  m_proxyModel->setDynamicSortFilter(false);
+  m_model->endBatch();
+  m_proxyModel->refilter();
+  m_proxyModel->setDynamicSortFilter(true);
+}
+
+int QJsonTreeWidget::updateWhere(QJsonTreeItemPredicate predicate, const QString &tag, const QVariant &value, void *context)
+{
+  QVariantMap values;
+  values.insert(tag,value);
+  return updateItems(predicate,context,values);
+}
+
+static bool queryMatches(const QJsonTreeItem* item, void* context)
+{
+  return static_cast<const QJsonTreeQuery*>(context)->matches(item);
+}
+
+int QJsonTreeWidget::updateWhere(const QString &query, const QVariantMap &values)
+{
+  QJsonTreeQuery q(query);
+  if (!q.isValid())
+  {
+    m_error = tr("updateWhere: ERROR %1 (at position %2):\n%3").arg(q.errorString()).arg(q.errorPosition()).arg(query);
+    return -1;
+  }
+  return updateItems(queryMatches,&q,values);
+}
+
+int QJsonTreeWidget::updateItems(QJsonTreeItemPredicate predicate, void *context, const QVariantMap &values)
+{
+  QJsonTreeItem* root = m_model->root();
+  if (!root || !predicate || values.isEmpty())
+    return 0;
+
+  // the whole tree must be built to be updated
+  m_model->fetchAll();
+
+  // one pass on the items, no children list is copied. all the matches are collected before changing anything, so the predicate
+  // (i.e. a path query) always sees the tree as it was. templates are skipped, as search and filter do
+  QVector<QJsonTreeItem*> matches;
+  QVector<QJsonTreeItem*> items;
+  items.append(root);
+  while (!items.isEmpty())
+  {
+    QJsonTreeItem* item = items.last();
+    items.pop_back();
+    if (item->isTemplate())
+      continue;
+    if (item != root && predicate(item,context))
+      matches.append(item);
+    for (int i=0; i < item->m_children.count(); i++)
+      items.append(item->m_children.at(i));
+  }
+
+  // the changed cells are emitted as ranges at the end
+  beginBatch();
+  foreach (QJsonTreeItem* item, matches)
+    m_model->setItemValues(item,values);
+  endBatch();
+  return matches.count();
+}
+
+bool QJsonTreeWidget::filter(const QString &query)
+{
+  // compiled once, then evaluated on the items maps
+  QJsonTreeQuery q(query);
+  if (!q.isValid())
+  {
+    m_error = tr("filter: ERROR %1 (at position %2):\n%3").arg(q.errorString()).arg(q.errorPosition()).arg(query);
+    return false;
+  }
+
+  // the whole tree must be built to be filtered
+  if (!q.isEmpty())
+    m_model->fetchAll();
+  m_proxyModel->setFilterQuery(q);
+  m_lastSearchText = QString();
+  return true;
+}
+
+void QJsonTreeWidget::clearSearch()
+{
+  m_searchResults.clear();
+  m_lastSearchText = QString();
+  m_currentSelection = QModelIndex();
+  m_view->selectionModel()->clearSelection();
+  emit searchPositionChanged(-1,0);
+
+  if (!m_expansionSaved)
+    return;
+
+  // collapse everything (a single layout), then expand back the saved items deepest first, so only the top level ones are laid out
+  m_view->collapseAll();
+  for (int i=m_savedExpansion.count() - 1; i >= 0; i--)
+  {
+    QModelIndex pidx = m_proxyModel->mapFromSource(m_savedExpansion.at(i));
+    if (pidx.isValid())
+      m_view->expand(pidx);
+  }
+  m_savedExpansion.clear();
+  m_expansionSaved = false;
+}
+
+void QJsonTreeWidget::saveExpansionState()
+{
+  // only the first search since the last clearSearch() saves the state
+  if (m_expansionSaved)
+    return;
+  m_expansionSaved = true;
+  m_savedExpansion.clear();
+
+  // walk the expanded items only, parents are stored before their children
+  QModelIndexList parents;
+  parents.append(QModelIndex());
+  while (!parents.isEmpty())
+  {
+    QModelIndex parent = parents.takeLast();
+    int rows = m_proxyModel->rowCount(parent);
+    for (int i=0; i < rows; i++)
+    {
+      QModelIndex pidx = m_proxyModel->index(i,0,parent);
+      if (!m_view->isExpanded(pidx))
+        continue;
+      m_savedExpansion.append(QPersistentModelIndex(m_proxyModel->mapToSource(pidx)));
+      parents.append(pidx);
+    }
+  }
+}
+
+static bool depthGreaterThan(const QPair<int,QModelIndex>& a, const QPair<int,QModelIndex>& b)
+{
+  return a.first > b.first;
+}
+
+void QJsonTreeWidget::expandForSearch(const QModelIndexList& matches)
+{
+  saveExpansionState();
+  if (!m_expandMatchesOnly)
+  {
+    this->expandAll();
+    return;
+  }
+
+  // collect the ancestors of the matches once each
+  QSet<QModelIndex> seen;
+  QList<QPair<int,QModelIndex> > ancestors;
+  foreach (QModelIndex idx, matches)
+  {
+    QList<QModelIndex> chain;
+    for (QModelIndex p = idx.parent(); p.isValid() && !seen.contains(p); p = p.parent())
+    {
+      seen.insert(p);
+      chain.append(p);
+    }
+    if (chain.isEmpty())
+      continue;
+
+    // the depth of the topmost new ancestor, the chain continues below it
+    int depth = 0;
+    for (QModelIndex p = chain.last().parent(); p.isValid(); p = p.parent())
+      depth++;
+    for (int i=chain.count() - 1; i >= 0; i--)
+      ancestors.append(qMakePair(depth++,chain.at(i)));
+  }
+
+  // expand the deepest first: an item under a collapsed parent is just marked as expanded, so the view lays out only
+  // the topmost ancestors, once each, instead of the whole tree
+  qStableSort(ancestors.begin(),ancestors.end(),depthGreaterThan);
+  for (int i=0; i < ancestors.count(); i++)
+  {
+    QModelIndex pidx = m_proxyModel->mapFromSource(ancestors.at(i).second);
+    if (pidx.isValid() && !m_view->isExpanded(pidx))
+      m_view->expand(pidx);
+  }
+}
+
+static QItemSelection mergedSelection(const QModelIndexList& indexes)
+{
+  // matching cells on the same row with adjacent columns become a single range first
+  QItemSelection rows;
+  foreach (QModelIndex idx, indexes)
+  {
+    if (!idx.isValid())
+      continue;
+    if (!rows.isEmpty())
+    {
+      const QItemSelectionRange& last = rows.last();
+      if (last.parent() == idx.parent() && last.top() == idx.row() && last.right() + 1 == idx.column())
+      {
+        rows.last() = QItemSelectionRange(last.topLeft(),idx);
+        continue;
+      }
+    }
+    rows.append(QItemSelectionRange(idx));
+  }
+
+  // then the same columns on adjacent rows
+  QItemSelection merged;
+  foreach (QItemSelectionRange r, rows)
+  {
+    if (!merged.isEmpty())
+    {
+      const QItemSelectionRange& last = merged.last();
+      if (last.parent() == r.parent() && last.left() == r.left() && last.right() == r.right() && last.bottom() + 1 == r.top())
+      {
+        merged.last() = QItemSelectionRange(last.topLeft(),r.bottomRight());
+        continue;
+      }
+    }
+    merged.append(r);
+  }
+  return merged;
+}
+
+void QJsonTreeWidget::searchInternal(const QModelIndexList& matches, bool focus)
+{
+  // the matches are collected first, then selected at once (a single selectionChanged)
+  m_searchResults = QJsonTreeSearchResults(matches);
+  QModelIndexList proxyindexes;
+  foreach (QModelIndex idx, matches)
+  {
+    proxyindexes.append(m_proxyModel->mapFromSource(idx));
+  }
+  m_view->selectionModel()->select(mergedSelection(proxyindexes),QItemSelectionModel::ClearAndSelect);
+  m_currentSelection = QModelIndex();
+  if (focus)
+    this->setFocus();
+  if (m_searchResults.isEmpty())
+    emit searchPositionChanged(-1,0);
+  this->nextSelection();
+}
+
+QModelIndexList QJsonTreeWidget::searchMatches() const
+{
+  QModelIndexList l;
+  for (int i=0; i < m_searchResults.count(); i++)
+  {
+    QModelIndex pidx = m_proxyModel->mapFromSource(m_searchResults.at(i));
+    if (pidx.isValid())
+      l.append(pidx);
+  }
+  return l;
+}
+
+void QJsonTreeWidget::onActionLoad()
+{
+  QString fname = QFileDialog::getOpenFileName(this, tr("Load JSON"),QString(),tr("JSON Files (*.json)"));
+  if (!fname.isEmpty())
+  {
+    loadJson(fname);
+    this->expandAll();
+    this->resizeColumnToContent(0);
+  }
+}
+
+void QJsonTreeWidget::onActionSave()
+{
+  QString fname = QFileDialog::getSaveFileName(this, tr("Save JSON"),QString(),tr("JSON Files (*.json)"));
+  if (!fname.isEmpty())
+  {
+    saveJson(fname,QJson::IndentMinimum);
+  }
+}
+
+void QJsonTreeWidget::onActionSaveHtml()
+{
+  QString fname = QFileDialog::getSaveFileName(this, tr("Save HTML"),QString(),tr("HTML Files (*.html)"));
+  if (!fname.isEmpty())
+  {
+    toHtmlFile(fname);
+  }
+}
+
+void QJsonTreeWidget::onActionEnableSort()
+{
+  setSortingEnabled(true);
+}
+
+void QJsonTreeWidget::onActionDisableSort()
+{
+  setSortingEnabled(false);
+}
+
+bool QJsonTreeWidget::validateItems(const QJsonTreeItem* item) const
+{
+  // whole tree ?
+  if (item == 0)
+  {
+    item = m_root;
+  }
+
+  // build the children not built yet (lazy loading), one level at a time while recursing
+  if (item->canFetchMore())
+    m_model->fetchAll(m_model->indexByItem(const_cast<QJsonTreeItem*>(item),0),false);
+
+  QString failname;
+  QString failcol;
+  QString failval;
+  if (!item->validateRegexp(&failcol,&failname,&failval))
+  {
+    QMessageBox::warning(0,tr("Invalid input"), tr("Name: ") % failname % "\n" % tr("Column: ") % failcol % "\n" % tr("Text: ") % failval);
+    return false;
+  }
+  if (item->childCount() > 0)
+  {
+    foreach (QJsonTreeItem* it, item->children())
+    {
+      // recurse
+      if (!validateItems(it))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool QJsonTreeWidget::findTag(const QString& tag, const QJsonTreeItem* item, QJsonTreeItem** found) const
+{
+  if (item == 0)
+  {
+    item = m_root;
+  }
+
+  if (item->map().contains(tag))
+  {
+    if (found)
+    {
+      *found = const_cast<QJsonTreeItem*>(item);
+    }
+    return true;
+  }
+
+  if (item->canFetchMore())
+    m_model->fetchAll(m_model->indexByItem(const_cast<QJsonTreeItem*>(item),0),false);
+  if (item->childCount() > 0)
+  {
+    foreach (QJsonTreeItem* it, item->children())
+    {
+      // recurse
+      if (findTag(tag,it,found))
+        return true;
+    }
+  }
+  return false;
+}
+
+void QJsonTreeWidget::toHtmlEnd(QXmlStreamWriter* str, const QHash<QString, QString> div) const
+{
+  // close html
+  str->writeEndElement(); // table
+  if (!div.isEmpty())
+  {
+    str->writeEndElement(); // div
+  }
+  str->writeEndElement(); // body
+  str->writeEndElement(); // html
+  delete str;
+}
+
+QXmlStreamWriter* QJsonTreeWidget::toHtmlStart(QString *dest, const QString &title, const QHash<QString, QString> div, const QModelIndex& index) const
+{
+  QXmlStreamWriter* str;
+  str = new QXmlStreamWriter(dest);
+  str->setAutoFormatting(true);
+
+  // html header
+  str->writeStartElement("html");
+  str->writeStartElement("head");
+  if (!title.isEmpty())
+  {
+    str->writeTextElement("title",title);
+  }
+  str->writeEndElement(); // head
+
+  // body
+  str->writeStartElement("body");
+  if (!div.isEmpty())
+  {
+    // div
+    str->writeStartElement("div");
+    foreach (QString k, div.keys())
+    {
+      str->writeAttribute(k,div[k]);
+    }
+  }
+
+  // table
+  str->writeStartElement("table");
+  str->writeAttribute("border","1");
+  str->writeStartElement("tr");
+  QJsonTreeItem* item = m_model->itemByModelIndex(QJsonSortFilterProxyModel::indexToSourceIndex(index));
+  for (int i=0; i < item->columnCount(); i++)
+  {
+    // headers
+    str->writeTextElement("th",item->headerNameByIdx(i));
+  }
+  str->writeEndElement(); // tr
+
+  return str;
+}
+
+void QJsonTreeWidget::toHtmlInternal(QXmlStreamWriter *str, const QModelIndex &index) const
+{
+  QJsonTreeItem* item = m_model->itemByModelIndex(QJsonSortFilterProxyModel::indexToSourceIndex(index));
+
+  // depth spaces
+  int depth = item->depth();
+  QString spaces;
+  for (int i=1; i < depth; i++)
+  {
+    spaces.append(" ");
+  }
+
+  str->writeStartElement("tr");
+  for (int i=0; i < item->columnCount(); i++)
+  {
+    QString s = item->map().value(item->headerTagByIdx(i),QString()).toString();
+
+    str->writeStartElement("td");
+    if (item->hasChildren())
+    {
+      str->writeStartElement("b"); // parent bold
+    }
+
+    if (i == 0)
+    {
+      // column 0 has spacing
+      if (!spaces.isEmpty())
+      {
+        str->writeStartElement("pre");
+        str->writeCharacters(spaces);
+      }
+    }
+    str->writeCharacters(s);
+    if (!spaces.isEmpty() && i == 0)
+    {
+      str->writeEndElement(); // pre
+    }
+    if (item->hasChildren())
+    {
+      str->writeEndElement(); // b
+    }
+    str->writeEndElement(); // td
+
+  }
+  str->writeEndElement(); // tr
+
+  // recurse
+  int i = 0;
+  while (true)
+  {
+    QModelIndex idx = index.child(i,0);
+    if (!idx.isValid())
+      break;
+    toHtmlInternal(str,idx);
+    i++;
+  }
+}
+
+bool QJsonTreeWidget::toHtmlFile(const QString &path, const QString &title, const QHash<QString,QString> div, QJsonTreeItem *item) const
+{
+  QFile f (path);
+  if (!f.open(QIODevice::WriteOnly))
+    return false;
+
+  QString s = toHtml(title,div,item);
+  if (s.isEmpty())
+  {
+    f.close();
+    return false;
+  }
+  f.write(s.toLatin1());
+  f.close();
+  return true;
+}
+
+void QJsonTreeWidget::setHeaderMenuEnabled(bool enable)
+{
+  if (enable)
+  {
+    m_view->header()->setContextMenuPolicy(Qt::ActionsContextMenu);
+  }
+  else
+  {
+    m_view->header()->setContextMenuPolicy(Qt::NoContextMenu);
+  }
+}
+
+QString QJsonTreeWidget::toHtml(const QString &title, const QHash<QString,QString> div, QJsonTreeItem *item) const
+{
+  QModelIndex idx;
+
+  // the whole subtree is written, build it if needed (lazy loading)
+  m_model->fetchAll(item ? m_model->indexByItem(item,0) : QModelIndex());
+  if (!item)
+  {
+    // get the view's root
+    idx = m_proxyModel->index(0,0,QModelIndex());
+  }
+  else
+  {
+    // specific item
+    idx = QJsonSortFilterProxyModel::indexToProxyIndex(m_model->indexByItem(item,0));
+  }
+
+  QString s;
+  QXmlStreamWriter* str = toHtmlStart(&s,title,div,idx);
+  toHtmlInternal(str,idx);
+
+  toHtmlEnd(str,div);
+  return s;
+}
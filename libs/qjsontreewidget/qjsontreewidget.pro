@@ -15,12 +15,32 @@ SOURCES += qjsontreewidget.cpp \
     qjsontreemodel.cpp \
     qjsontreeitem.cpp \
     qjsontreeitemdelegate.cpp \
-    qjsonsortfilterproxymodel.cpp
+    qjsonsortfilterproxymodel.cpp \
+    qjsontreestreamreader.cpp \
+    qjsontreestreamwriter.cpp \
+    qjsontreeloader.cpp \
+    qjsontreeheaders.cpp \
+    qjsontreeitemarena.cpp \
+    qjsontreesearchindex.cpp \
+    qjsontreesearchresults.cpp \
+    qjsontreesearchsession.cpp \
+    qjsontreequery.cpp \
+    qjsontreevaluedomain.cpp
 
 HEADERS += qjsontreewidget.h \
     qjsontreemodel.h \
     qjsontreeitem.h \
     qjsontreeitemdelegate.h \
-    qjsonsortfilterproxymodel.h
+    qjsonsortfilterproxymodel.h \
+    qjsontreestreamreader.h \
+    qjsontreestreamwriter.h \
+    qjsontreeloader.h \
+    qjsontreeheaders.h \
+    qjsontreeitemarena.h \
+    qjsontreesearchindex.h \
+    qjsontreesearchresults.h \
+    qjsontreesearchsession.h \
+    qjsontreequery.h \
+    qjsontreevaluedomain.h
 
 INCLUDEPATH += ../qjson/include
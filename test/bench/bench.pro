@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# QTestLib benchmarks, run "bench -help" for the options.
+# a single function runs with "bench <function>" (i.e. for meaningful peak memory figures)
+#
+#-------------------------------------------------
+
+QT       += core gui
+CONFIG   += qtestlib
+
+TARGET = bench
+TEMPLATE = app
+
+SOURCES += benchmark.cpp
+
+HEADERS  += \
+    benchmark.h
+
+INCLUDEPATH += ../../libs/qjsontreewidget \
+    ../../libs/qjson/include
+
+LIBS += -L../../libs/qjsontreewidget/lib -lqjsontreewidget
+LIBS += -L../../libs/qjson/lib -lqjson
+win32:LIBS += -lpsapi
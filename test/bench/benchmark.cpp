@@ -0,0 +1,276 @@
+#include "benchmark.h"
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// returns the peak resident set size of the process, in KB (-1 if not available)
+static qint64 peakRss()
+{
+#if defined(Q_OS_WIN)
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(),&pmc,sizeof(pmc)))
+    return -1;
+  return pmc.PeakWorkingSetSize / 1024;
+#else
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF,&ru) != 0)
+    return -1;
+#if defined(Q_OS_MAC)
+  // bytes there
+  return ru.ru_maxrss / 1024;
+#else
+  return ru.ru_maxrss;
+#endif
+#endif
+}
+
+// writes a document with parents items under the top level one, each having children items. child is the JSON of a child item,
+// %1 is replaced by its number (unique in the document). the document is written in chunks, it's never held in memory
+static void writeDocument(QIODevice* dev, const QString& headers, int parents, int children, const QString& child)
+{
+  dev->write(QString("{ \"_desc_\" : \"Benchmark\", \"name\" : \"bench\", \"version\" : 1, \"_headers_\" : \"%1\", \"_children_\" : [\n")
+             .arg(headers).toUtf8());
+  int n = 0;
+  for (int p=0; p < parents; p++)
+  {
+    QByteArray chunk = QString("  { \"_desc_\" : \"Parent %1\", \"name\" : \"parent%1\", \"_widget_:value\" : \"Tree\", \"_children_\" : [\n")
+        .arg(p).toUtf8();
+    for (int c=0; c < children; c++)
+    {
+      chunk += "    ";
+      chunk += child.arg(n++).toUtf8();
+      chunk += (c == children - 1 ? "\n" : ",\n");
+    }
+    chunk += (p == parents - 1 ? "  ] }\n" : "  ] },\n");
+    dev->write(chunk);
+  }
+  dev->write("] }\n");
+}
+
+// loads a document generated by writeDocument() with loadJsonStream()
+static bool loadDocument(QJsonTreeWidget* w, const QString& headers, int parents, int children, const QString& child)
+{
+  QBuffer buf;
+  buf.open(QIODevice::ReadWrite);
+  writeDocument(&buf,headers,parents,children,child);
+  buf.seek(0);
+  return w->loadJsonStream(buf);
+}
+
+// appends the indexes of all the cells under parent, depth first
+static void collectIndexes(const QAbstractItemModel* model, const QModelIndex& parent, QModelIndexList* indexes)
+{
+  for (int r=0; r < model->rowCount(parent); r++)
+  {
+    for (int c=0; c < model->columnCount(parent); c++)
+      indexes->append(model->index(r,c,parent));
+    collectIndexes(model,model->index(r,0,parent),indexes);
+  }
+}
+
+QJsonTreeBenchmark::QJsonTreeBenchmark()
+{
+}
+
+QString QJsonTreeBenchmark::loadDocumentPath()
+{
+  if (!m_loadDocument.isOpen())
+  {
+    m_loadDocument.open();
+    writeDocument(&m_loadDocument,"name:name:0,description:_desc_:1,value:value:2",BENCH_LOAD_PARENTS,BENCH_LOAD_CHILDREN,
+                  "{ \"_desc_\" : \"Item %1\", \"name\" : \"item%1\", \"value\" : %1, \"_widget_:value\" : \"QSpinBox\", "
+                  "\"_valuemin_:value\" : 0, \"_valuemax_:value\" : 1000000 }");
+    m_loadDocument.flush();
+  }
+  return m_loadDocument.fileName();
+}
+
+void QJsonTreeBenchmark::loadJsonParsed()
+{
+  // the whole document is parsed to a QVariantMap first, then built by loadJsonInternal()
+  QString path = loadDocumentPath();
+  QJsonTreeWidget w;
+  qint64 before = peakRss();
+  QBENCHMARK_ONCE
+  {
+    QFile f(path);
+    QVERIFY(f.open(QIODevice::ReadOnly));
+    QVERIFY2(w.loadJson(f),qPrintable(w.error()));
+  }
+  qDebug("%lld bytes, peak RSS %lld KB (+%lld KB while loading)",QFileInfo(path).size(),peakRss(),peakRss() - before);
+}
+
+void QJsonTreeBenchmark::loadJsonStream()
+{
+  // items are built while the device is read
+  QString path = loadDocumentPath();
+  QJsonTreeWidget w;
+  qint64 before = peakRss();
+  QBENCHMARK_ONCE
+  {
+    QFile f(path);
+    QVERIFY(f.open(QIODevice::ReadOnly));
+    QVERIFY2(w.loadJsonStream(f),qPrintable(w.error()));
+  }
+  qDebug("%lld bytes, peak RSS %lld KB (+%lld KB while loading)",QFileInfo(path).size(),peakRss(),peakRss() - before);
+}
+
+void QJsonTreeBenchmark::modelData()
+{
+  // what the view asks for each visible cell, on every cell of the tree
+  BenchTreeWidget w;
+  w.setSpecialFlags(w.specialFlags() | QJsonTreeItem::HonorHide | QJsonTreeItem::HonorReadOnly);
+  QVERIFY2(loadDocument(&w,"name:name:0,description:_desc_:1,value:value:2,enabled:enabled:3",BENCH_DATA_PARENTS,BENCH_DATA_CHILDREN,
+                        "{ \"_desc_\" : \"Item %1\", \"name\" : \"item%1\", \"value\" : \"text %1\", \"_widget_:value\" : \"QLineEdit\", "
+                        "\"_readonly_:value\" : false, \"enabled\" : true, \"_widget_:enabled\" : \"QCheckBox\", \"_hide_:enabled\" : false }"),
+           qPrintable(w.error()));
+  const QJsonTreeModel* model = w.treeModel();
+  QModelIndexList indexes;
+  collectIndexes(model,QModelIndex(),&indexes);
+
+  const int roles[] = { Qt::DisplayRole, Qt::EditRole, Qt::ForegroundRole, Qt::BackgroundRole, Qt::FontRole };
+  const int nroles = sizeof(roles) / sizeof(roles[0]);
+  QBENCHMARK
+  {
+    foreach (const QModelIndex& idx, indexes)
+    {
+      model->flags(idx);
+      for (int i=0; i < nroles; i++)
+        model->data(idx,roles[i]);
+    }
+  }
+  qDebug("%d cells, flags() and %d data() roles each",indexes.count(),nroles);
+}
+
+void QJsonTreeBenchmark::siblingRows_data()
+{
+  QTest::addColumn<int>("siblings");
+  QTest::newRow("1k") << 1000;
+  QTest::newRow("10k") << 10000;
+  QTest::newRow("100k") << 100000;
+}
+
+void QJsonTreeBenchmark::siblingRows()
+{
+  // the parent lookups the view does while scrolling, and the item to index mapping, on each sibling of a flat list
+  QFETCH(int,siblings);
+  BenchTreeWidget w;
+  QVERIFY2(loadDocument(&w,"name:name:0,value:value:1",1,siblings,"{ \"name\" : \"item%1\", \"value\" : %1 }"),qPrintable(w.error()));
+  QJsonTreeModel* model = w.treeModel();
+  QModelIndex parent = model->index(0,0,model->index(0,0));
+  QJsonTreeItem* parentItem = model->itemByModelIndex(parent);
+  QCOMPARE(model->rowCount(parent),siblings);
+
+  QBENCHMARK
+  {
+    for (int i=0; i < siblings; i++)
+    {
+      QJsonTreeItem* item = parentItem->child(i);
+      model->parent(model->indexByItem(item,0));
+    }
+  }
+}
+
+void QJsonTreeBenchmark::searchThreads_data()
+{
+  // 1, 2, 4, ... up to all the cores
+  QTest::addColumn<int>("threads");
+  int cores = QThread::idealThreadCount();
+  for (int t=1; t < cores; t *= 2)
+    QTest::newRow(qPrintable(QString("%1 threads").arg(t))) << t;
+  QTest::newRow(qPrintable(QString("%1 threads").arg(qMax(cores,1)))) << qMax(cores,1);
+}
+
+void QJsonTreeBenchmark::searchThreads()
+{
+  // a full scan (no search index), the thread pool jobs are limited to the given threads
+  QFETCH(int,threads);
+  BenchTreeWidget w;
+  QVERIFY2(loadDocument(&w,"name:name:0,description:_desc_:1,value:value:2,comment:comment:3",BENCH_SEARCH_PARENTS,BENCH_SEARCH_CHILDREN,
+                        "{ \"_desc_\" : \"Item %1 description\", \"name\" : \"item%1\", \"value\" : \"value %1\", "
+                        "\"comment\" : \"a longer comment for item %1, so the scan has some text to go through\" }"),
+           qPrintable(w.error()));
+  QThreadPool::globalInstance()->setMaxThreadCount(threads);
+  QRegExp rx("value \\d*999$");
+  int found = 0;
+  QBENCHMARK
+  {
+    found = w.treeProxyModel()->searchMatches(rx).count();
+  }
+  qDebug("%d matches",found);
+}
+
+void QJsonTreeBenchmark::sortRows_data()
+{
+  QTest::addColumn<int>("column");
+  QTest::addColumn<bool>("natural");
+  QTest::newRow("numbers") << 1 << false;
+  QTest::newRow("text") << 0 << false;
+  QTest::newRow("natural text") << 0 << true;
+}
+
+void QJsonTreeBenchmark::sortRows()
+{
+  // a single sort on a new proxy, so the sort keys are built too
+  QFETCH(int,column);
+  QFETCH(bool,natural);
+  BenchTreeWidget w;
+  QVERIFY2(loadDocument(&w,"name:name:0,value:value:1",1,BENCH_SORT_ROWS,"{ \"name\" : \"item%1\", \"value\" : %1 }"),qPrintable(w.error()));
+  QJsonSortFilterProxyModel proxy;
+  proxy.setDynamicSortFilter(false);
+  proxy.setNaturalSortEnabled(natural);
+  proxy.setSourceModel(w.treeModel());
+
+  // map the rows first, the benchmark measures the sort only
+  QModelIndex parent = proxy.index(0,0,proxy.index(0,0));
+  QCOMPARE(proxy.rowCount(parent),BENCH_SORT_ROWS);
+  QBENCHMARK_ONCE
+  {
+    proxy.sort(column,Qt::DescendingOrder);
+  }
+}
+
+void QJsonTreeBenchmark::paintDrawColumns_data()
+{
+  QTest::addColumn<bool>("cached");
+  QTest::newRow("pixmap cache") << true;
+  QTest::newRow("no pixmap cache") << false;
+}
+
+void QJsonTreeBenchmark::paintDrawColumns()
+{
+  // a view full of checkboxes and buttons painted by the delegate, repainted as a whole
+  QFETCH(bool,cached);
+  BenchTreeWidget w;
+  QVERIFY2(loadDocument(&w,"name:name:0,enabled:enabled:1,start:_button1_:2:draw,stop:_button2_:3:draw",1,BENCH_PAINT_ROWS,
+                        "{ \"name\" : \"item%1\", \"enabled\" : true, \"_widget_:enabled\" : \"QCheckBox\", "
+                        "\"_button1_\" : \"QPushButton,,start\", \"_button2_\" : \"QPushButton,,stop\" }"),
+           qPrintable(w.error()));
+  w.resize(1024,768);
+  w.show();
+  QTest::qWaitForWindowShown(&w);
+  w.expandAll();
+
+  // a zero limit makes every control rendered from scratch
+  int limit = QPixmapCache::cacheLimit();
+  QPixmapCache::clear();
+  if (!cached)
+    QPixmapCache::setCacheLimit(0);
+  QWidget* viewport = w.treeView()->viewport();
+  QPixmap pm(viewport->size());
+  QBENCHMARK
+  {
+    viewport->render(&pm);
+  }
+  QPixmapCache::setCacheLimit(limit);
+}
+
+void QJsonTreeBenchmark::cleanupTestCase()
+{
+  QThreadPool::globalInstance()->setMaxThreadCount(QThread::idealThreadCount());
+}
+
+QTEST_MAIN(QJsonTreeBenchmark)
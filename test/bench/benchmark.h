@@ -0,0 +1,57 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QtCore>
+#include <QtTest>
+#include <qjsontreewidget.h>
+
+#define BENCH_LOAD_PARENTS 1000 // loadJson*() document: parents under the top level item
+#define BENCH_LOAD_CHILDREN 300 // loadJson*() document: children of each parent
+#define BENCH_DATA_PARENTS 100 // modelData() document: parents under the top level item
+#define BENCH_DATA_CHILDREN 1000 // modelData() document: children of each parent
+#define BENCH_SEARCH_PARENTS 250 // searchThreads() document: parents under the top level item
+#define BENCH_SEARCH_CHILDREN 1000 // searchThreads() document: children of each parent (4 columns each, 1M cells overall)
+#define BENCH_SORT_ROWS 100000 // sortRows() document: siblings to sort
+#define BENCH_PAINT_ROWS 2000 // paintDrawColumns() document: rows, more than a view shows
+
+/**
+ * @brief exposes the QJsonTreeWidget model, proxy and view to the benchmarks
+ *
+ */
+class BenchTreeWidget : public QJsonTreeWidget
+{
+public:
+  QJsonTreeModel* treeModel() const { return model(); }
+  QJsonSortFilterProxyModel* treeProxyModel() const { return proxyModel(); }
+  QTreeView* treeView() const { return view(); }
+};
+
+class QJsonTreeBenchmark : public QObject
+{
+  Q_OBJECT
+
+public:
+  QJsonTreeBenchmark();
+
+private slots:
+  // run each of them in its own process ("bench loadJsonParsed", "bench loadJsonStream"), the peak memory is per process
+  void loadJsonParsed();
+  void loadJsonStream();
+  void modelData();
+  void siblingRows_data();
+  void siblingRows();
+  void searchThreads_data();
+  void searchThreads();
+  void sortRows_data();
+  void sortRows();
+  void paintDrawColumns_data();
+  void paintDrawColumns();
+  void cleanupTestCase();
+
+private:
+  QString loadDocumentPath();
+
+  QTemporaryFile m_loadDocument;
+};
+
+#endif // BENCHMARK_H
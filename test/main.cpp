@@ -1,11 +1,11 @@
-#include <QtGui/QApplication>
-#include "dialog.h"
-
-int main(int argc, char *argv[])
-{
-    QApplication a(argc, argv);
-    Dialog w;
-    w.show();
-
-    return a.exec();
-}
+#include <QtGui/QApplication>
+#include "dialog.h"
+
+int main(int argc, char *argv[])
+{
+    QApplication a(argc, argv);
+    Dialog w;
+    w.show();
+
+    return a.exec();
+}